@@ -15,11 +15,14 @@ project "Raytracer"
 
       "../Walnut/Walnut/src",
 
+      "../RaytracerCore/src",
+
       "%{IncludeDir.VulkanSDK}",
    }
 
    links
    {
+       "RaytracerCore",
        "Walnut"
    }
 
@@ -4,59 +4,181 @@
 #include "Walnut/Image.h"
 #include "Walnut/Random.h"
 #include "Walnut/Timer.h"
+#include "Walnut/Input/Input.h"
 
 #include "Renderer.h"
 #include "Camera.h"
+#include "SceneFactory.h"
+#include "MeshLoader.h"
+#include "SceneIO.h"
+#include "Profiler.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
-Sphere createSphere();
-Plane createPlane();
-Model createCube();
-
 class ExampleLayer : public Walnut::Layer
 {
 public:
 	ExampleLayer()
 		: m_camera(87.f, 0.1f, 100.f)
 	{
-		m_scene.materials.push_back(Material{ { 1.0f, 0.0f, 0.0f }, 0.1f, 1.f });
-		m_scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f });
-		m_scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f , { 1.0f, 1.0f, 1.0f } , 5.0f});
-
-		{
-			Sphere sphere;
-			sphere.Position = { 5.f,5.f,-1.f };
-			sphere.Radius = 2.f;
-			sphere.MaterialIndex = 2;
-			m_scene.Objects.push_back(std::make_unique<Sphere>(sphere));
-		}
-		{
-			Sphere sphere = createSphere();
-			m_scene.Objects.push_back(std::make_unique<Sphere>(sphere));
-		}
-		{
-			Plane plane = createPlane();
-			plane.Position.y = -1;
-			plane.MaterialIndex = 1;
-			m_scene.Objects.push_back(std::make_unique<Plane>(plane));
-		}
-		{
-			Model cube = createCube();
-			cube.Position.x = 3.0f;
-			cube.MaterialIndex = 1;
-			m_scene.Objects.push_back(std::make_unique<Model>(cube));
-		}
+		m_scene = CreateDefaultScene();
+		SetProfilerThreadName("Main");
+		m_Renderer.getSettings().ProgressivePreview = true;
 	}
 	virtual void OnUIRender() override
 	{
+		RT_PROFILE_SCOPE("ExampleLayer::OnUIRender");
 		ImGui::Begin("Settings");
 		ImGui::Text("Render Time: %f ms",m_RenderTime);
 		ImGui::Text("Sample No.: %i", m_Renderer.getFrameIndex());
+		ImGui::Text("Throughput: %.2f Mrays/s", m_Renderer.GetMraysPerSecond());
+		const CompiledScene& compiledScene = m_Renderer.GetCompiledScene();
+		ImGui::Text("Scene BVH: %u nodes, %zu spheres, %zu meshes, %zu planes", compiledScene.GetStats().NodeCount,
+			compiledScene.GetSpheres().Size(), compiledScene.GetMeshInstances().size(), compiledScene.GetPlanes().Size());
+		ImGui::Text("Last Scene Update: %.3f ms, %u refits since rebuild", compiledScene.GetUpdateMs(), compiledScene.GetRefitCount());
 		ImGui::Checkbox("Accumulate Samples", &m_Renderer.getSettings().Accumulate);
 		if (ImGui::Button("Reset"))
 			m_Renderer.ResetFrameIndex();
 		ImGui::DragInt("Bounces", (int*)&m_Renderer.getBounces(),0.1f, 1, 128);
+		ImGui::Checkbox("Anti-Aliasing", &m_Renderer.getSettings().Jitter);
+		const char* samplers[] = { GetSamplerTypeName(SamplerType::Random), GetSamplerTypeName(SamplerType::Sobol),
+			GetSamplerTypeName(SamplerType::BlueNoise) };
+		// Samples of different sequences don't mix, so the accumulation starts over
+		if (ImGui::Combo("Sampler", (int*)&m_Renderer.getSettings().Sampler, samplers, 3))
+			m_Renderer.ResetFrameIndex();
+		ImGui::Checkbox("Light Sampling", &m_Renderer.getSettings().NextEventEstimation);
+		ImGui::SameLine();
+		ImGui::Text("(%zu emitters)", m_Renderer.GetCompiledScene().GetEmitters().size());
+		ImGui::Checkbox("Adaptive Sampling", &m_Renderer.getSettings().AdaptiveSampling);
+		if (m_Renderer.getSettings().AdaptiveSampling)
+		{
+			ImGui::DragFloat("Noise Threshold", &m_Renderer.getSettings().NoiseThreshold, 0.0005f, 0.0005f, 0.5f, "%.4f");
+			ImGui::DragInt("Min Samples", (int*)&m_Renderer.getSettings().MinSamples, 0.2f, 2, 1024);
+			ImGui::Checkbox("Show Active Pixels", &m_Renderer.getSettings().ShowActivePixels);
+			const uint32_t pixelCount = m_Renderer.GetWidth() * m_Renderer.GetHeight();
+			ImGui::Text("Active Pixels: %u (%.1f%%)", m_Renderer.GetActivePixelCount(),
+				pixelCount > 0 ? 100.0f * m_Renderer.GetActivePixelCount() / pixelCount : 0.0f);
+		}
+		ImGui::Checkbox("Temporal Reprojection", &m_Renderer.getSettings().TemporalReprojection);
+		if (m_Renderer.getSettings().TemporalReprojection)
+		{
+			ImGui::DragInt("Max History Samples", (int*)&m_Renderer.getSettings().MaxHistorySamples, 0.5f, 1, 4096);
+			ImGui::DragFloat("Depth Tolerance", &m_Renderer.getSettings().DepthTolerance, 0.001f, 0.001f, 1.0f);
+			ImGui::DragFloat("Normal Tolerance", &m_Renderer.getSettings().NormalTolerance, 0.005f, 0.0f, 1.0f);
+			const uint32_t pixelCount = m_Renderer.GetWidth() * m_Renderer.GetHeight();
+			ImGui::Text("Reprojected Pixels: %u (%.1f%%)", m_Renderer.GetReprojectedPixelCount(),
+				pixelCount > 0 ? 100.0f * m_Renderer.GetReprojectedPixelCount() / pixelCount : 0.0f);
+		}
+		ImGui::Checkbox("Progressive Preview", &m_Renderer.getSettings().ProgressivePreview);
+		if (m_Renderer.getSettings().ProgressivePreview)
+		{
+			ImGui::DragFloat("Frame Budget (ms)", &m_Renderer.getSettings().FrameBudgetMs, 0.5f, 4.0f, 200.0f);
+			ImGui::DragInt("Preview Bounces", (int*)&m_Renderer.getSettings().PreviewBounces, 0.1f, 1, 32);
+			ImGui::Text("Preview Resolution: 1/%u", m_Renderer.GetPreviewScale() * m_Renderer.GetPreviewScale());
+		}
+		Tonemapper::Settings& tonemapper = m_Renderer.GetTonemapper().GetSettings();
+		ImGui::DragFloat("Exposure (EV)", &tonemapper.Exposure, 0.05f, -10.0f, 10.0f);
+		const char* toneMapOperators[] = { GetToneMapOperatorName(ToneMapOperator::Clamp),
+			GetToneMapOperatorName(ToneMapOperator::Reinhard), GetToneMapOperatorName(ToneMapOperator::ACES) };
+		ImGui::Combo("Tone Mapping", (int*)&tonemapper.Operator, toneMapOperators, 3);
+		ImGui::Checkbox("sRGB Output", &tonemapper.SRGB);
+		ImGui::Text("Resolve Time: %.2f ms", m_Renderer.GetResolveMs());
+		ImGui::Checkbox("Denoise", &m_Renderer.getSettings().Denoise);
+		if (m_Renderer.getSettings().Denoise)
+		{
+			Denoiser::Settings& denoiser = m_Renderer.GetDenoiser().GetSettings();
+			ImGui::DragInt("Filter Iterations", (int*)&denoiser.Iterations, 0.05f, 1, 5);
+			ImGui::DragFloat("Colour Sigma", &denoiser.ColorSigma, 0.01f, 0.01f, 10.0f);
+			ImGui::DragFloat("Normal Sigma", &denoiser.NormalSigma, 0.01f, 0.01f, 2.0f);
+			ImGui::DragFloat("Depth Sigma", &denoiser.DepthSigma, 0.001f, 0.001f, 1.0f);
+			ImGui::Text("Denoise Time: %.2f ms", m_Renderer.GetDenoiseMs());
+		}
+		ImGui::Checkbox("Wavefront", &m_Renderer.getSettings().Wavefront);
+		if (m_Renderer.getSettings().Wavefront)
+		{
+			ImGui::Checkbox("Russian Roulette", &m_Renderer.getSettings().RussianRoulette);
+			if (m_Renderer.getSettings().RussianRoulette)
+				ImGui::DragInt("Roulette Depth", (int*)&m_Renderer.getSettings().RussianRouletteDepth, 0.1f, 1, 32);
+		}
+		ImGui::Checkbox("Packet Tracing", &m_Renderer.getSettings().PacketTracing);
+		if (m_Renderer.getSettings().PacketTracing)
+		{
+			const char* packetSizes[] = { "4x4", "8x8" };
+			int packetSize = m_Renderer.getSettings().PacketSize == 4 ? 0 : 1;
+			if (ImGui::Combo("Packet Size", &packetSize, packetSizes, 2))
+				m_Renderer.getSettings().PacketSize = packetSize == 0 ? 4 : 8;
+		}
+
+		ImGui::DragInt("Threads (0 = all)", (int*)&m_Renderer.getSettings().ThreadCount, 0.1f, 0, 256);
+		ImGui::DragInt("Tile Size", (int*)&m_Renderer.getSettings().TileSize, 1.0f, 8, 256);
+		if (ImGui::TreeNode("Thread Stats"))
+		{
+			const auto& threadStats = m_Renderer.GetThreadStats();
+			const auto& threadRays = m_Renderer.GetThreadRayCounts();
+			for (size_t i = 0; i < threadStats.size() && i < threadRays.size(); i++)
+			{
+				const WorkerStats& stats = threadStats[i];
+				ImGui::Text("Thread %zu: %u tiles (%u stolen), %.1f ms, %.2f Mrays", i, stats.TileCount, stats.StolenCount,
+					stats.BusyMs, threadRays[i] * 1e-6f);
+			}
+			ImGui::TreePop();
+		}
+		if (ImGui::TreeNode("Frame Stats"))
+		{
+			const FrameStats& frame = m_Renderer.GetFrameStats();
+			ImGui::Text("Trace: %.2f ms of %.2f ms, %.2f Mrays/s", frame.TraceMs, frame.FrameMs, frame.MraysPerSecond);
+			ImGui::Text("Tiles: %u, %.3f ms average, %.3f ms slowest", frame.TileCount, frame.AverageTileMs, frame.MaxTileMs);
+#if RT_STATS
+			const TraceCounters& counters = frame.Counters;
+			const double rays = (double)std::max<uint64_t>(counters.GetRayCount(), 1);
+			ImGui::Text("Rays: %.3fM primary, %.3fM secondary, %.3fM shadow", counters.PrimaryRays * 1e-6,
+				counters.SecondaryRays * 1e-6, counters.ShadowRays * 1e-6);
+			ImGui::Text("Per ray: %.1f nodes, %.1f primitive tests", counters.NodeVisits / rays, counters.PrimitiveTests / rays);
+			float pathLengths[TraceCounters::PathLengthBins];
+			for (uint32_t i = 0; i < TraceCounters::PathLengthBins; i++)
+				pathLengths[i] = (float)counters.PathLengths[i];
+			ImGui::PlotHistogram("Path Lengths", pathLengths, TraceCounters::PathLengthBins, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+#else
+			ImGui::TextDisabled("Trace counters are compiled out of this build");
+#endif
+			ImGui::InputText("Log Path", m_StatsLogPath, sizeof(m_StatsLogPath));
+			bool logging = m_StatsLog.IsOpen();
+			if (ImGui::Checkbox("Log Every Frame", &logging))
+			{
+				if (!logging)
+					m_StatsLog.Close();
+				else if (m_StatsLog.Open(m_StatsLogPath, m_StatsLogError))
+					m_StatsLogError.clear();
+			}
+			if (!m_StatsLogError.empty())
+				ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_StatsLogError.c_str());
+			ImGui::TreePop();
+		}
+		if (ImGui::TreeNode("Profiler"))
+		{
+			// Records into ring buffers while on, so saving keeps the last few seconds of the session
+			bool recording = IsProfilerEnabled();
+			if (ImGui::Checkbox("Record Timeline", &recording))
+				SetProfilerEnabled(recording);
+			ImGui::InputText("Trace Path", m_TracePath, sizeof(m_TracePath));
+			if (ImGui::Button("Save Trace"))
+			{
+				if (WriteChromeTrace(m_TracePath, m_TraceError))
+					m_TraceError.clear();
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Clear"))
+				ClearProfile();
+			if (!m_TraceError.empty())
+				ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_TraceError.c_str());
+			ImGui::TreePop();
+		}
+
+		// Only offer the instruction sets this CPU supports
+		const char* simdLevels[] = { GetSIMDLevelName(SIMDLevel::Scalar), GetSIMDLevelName(SIMDLevel::SSE), GetSIMDLevelName(SIMDLevel::AVX2) };
+		int simdLevel = (int)GetIntersectKernels().Level;
+		if (ImGui::Combo("Intersection Kernels", &simdLevel, simdLevels, (int)GetSupportedSIMDLevel() + 1))
+			SetIntersectKernels((SIMDLevel)simdLevel);
 		ImGui::End();
 
 
@@ -66,50 +188,123 @@ public:
 			ImGui::DragFloat("Near Clip", m_camera.getNearClip(), 1, 0) ||
 			ImGui::DragFloat("Far Clip", m_camera.getFarClip(), 1))
 			m_camera.updateView();
+		if (ImGui::DragFloat("Aperture", m_camera.getAperture(), 0.01f, 0.0f, 10.0f) ||
+			ImGui::DragFloat("Focus Distance", m_camera.getFocusDistance(), 0.05f, 0.01f, 1000.0f))
+			m_Renderer.ResetFrameIndex();
 		ImGui::End();
 
 
 		ImGui::Begin("Scene");
 		if (ImGui::Button("Create Sphere"))
-			m_scene.Objects.push_back(std::make_unique<Sphere>(createSphere()));
+			m_scene.AddObject(std::make_unique<Sphere>(createSphere()));
 		if (ImGui::Button("Create Plane"))
-			m_scene.Objects.push_back(std::make_unique<Plane>(createPlane()));
+			m_scene.AddObject(std::make_unique<Plane>(createPlane()));
 		if (ImGui::Button("Create Cube"))
-			m_scene.Objects.push_back(std::make_unique<Model>(createCube()));
+			m_scene.AddObject(std::make_unique<Model>(createCube()));
+
+		ImGui::InputText("Model Path", m_ModelPath, sizeof(m_ModelPath));
+		if (ImGui::Button("Import Model"))
+		{
+			auto mesh = std::make_shared<Mesh>();
+			if (LoadMesh(m_ModelPath, *mesh, m_ImportError))
+			{
+				m_scene.AddObject(std::make_unique<Model>(std::move(mesh), glm::vec3(0.0f), 0));
+				m_ImportError.clear();
+			}
+		}
+		if (!m_ImportError.empty())
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_ImportError.c_str());
+
+		ImGui::InputText("Scene Path", m_ScenePath, sizeof(m_ScenePath));
+		if (ImGui::Button("Save Scene"))
+		{
+			if (SaveScene(m_ScenePath, m_scene, m_SceneError))
+				m_SceneError.clear();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Load Scene"))
+		{
+			Scene scene;
+			if (LoadScene(m_ScenePath, scene, m_SceneError))
+			{
+				m_scene = std::move(scene);
+				m_SceneError.clear();
+			}
+		}
+		if (!m_SceneError.empty())
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_SceneError.c_str());
 
 		ImGui::Separator();
+		// Added after the loop, growing Objects would move the entries it is iterating over
+		std::unique_ptr<Model> newInstance;
 		for (size_t i = 0; i < m_scene.Objects.size(); i ++) {
 			auto& obj = m_scene.Objects[i];
 			ImGui::PushID(&obj);
 			if (ImGui::Button("Delete Object"))
 			{
-				m_scene.Objects.erase(m_scene.Objects.begin() + i);
+				m_scene.RemoveObject(i);
 				ImGui::PopID();
 				break;
 			}
-			ImGui::DragFloat3("Position", glm::value_ptr(obj->Position), 0.01f);
+			// Edits are reported to the scene so the renderer refits instead of recompiling
+			bool changed = ImGui::DragFloat3("Position", glm::value_ptr(obj->Position), 0.01f);
 
 			if(dynamic_cast<const Sphere*>(obj.get()))
-				ImGui::DragFloat("Radius", &dynamic_cast<Sphere*>(obj.get())->Radius, 0.1f);
-			
-			ImGui::DragInt("Material Index", &obj->MaterialIndex, 1.0f, 0.0f, (int)m_scene.materials.size()-1);
+				changed |= ImGui::DragFloat("Radius", &dynamic_cast<Sphere*>(obj.get())->Radius, 0.1f);
+
+			if (Model* model = dynamic_cast<Model*>(obj.get()))
+			{
+				changed |= ImGui::DragFloat3("Rotation", glm::value_ptr(model->Rotation), 0.5f);
+				if (ImGui::DragFloat3("Scale", glm::value_ptr(model->Scale), 0.01f))
+				{
+					// Dragging through zero would flatten the mesh into a singular transform, keep the sign so it can still be mirrored
+					for (int i = 0; i < 3; i++)
+						if (std::abs(model->Scale[i]) < 0.001f)
+							model->Scale[i] = std::copysign(0.001f, model->Scale[i]);
+					changed = true;
+				}
+				if (ImGui::Button("Add Instance"))
+				{
+					// Shares the mesh and its BVH, only the transform and material are new
+					newInstance = std::make_unique<Model>(model->GetSharedGeometry(), model->Position + glm::vec3(1.0f, 0.0f, 0.0f), model->MaterialIndex);
+					newInstance->Rotation = model->Rotation;
+					newInstance->Scale = model->Scale;
+				}
+
+				const BVHStats& stats = model->GetBVHStats();
+				ImGui::Text("Triangles: %zu", model->GetTriangleCount());
+				ImGui::Text("BVH: %u nodes, %u leaves, depth %u", stats.NodeCount, stats.LeafCount, stats.MaxDepth);
+				ImGui::Text("Leaf size: %.2f avg, %u max", stats.AverageLeafSize, stats.MaxLeafSize);
+				ImGui::Text("Build Time: %f ms, SAH cost: %.2f", stats.BuildTimeMs, stats.SAHCost);
+			}
+
+			changed |= ImGui::DragInt("Material Index", &obj->MaterialIndex, 1.0f, 0.0f, (int)m_scene.materials.size()-1);
+			if (changed)
+				m_scene.MarkObjectChanged(i);
 			ImGui::Separator();
 			ImGui::PopID();
 		}
+		if (newInstance)
+			m_scene.AddObject(std::move(newInstance));
 		ImGui::End();
 
 
 		ImGui::Begin("Materials");
 		if (ImGui::Button("Create Material"))
+		{
 			m_scene.materials.push_back(Material{});
+			m_scene.MarkMaterialsChanged();
+		}
 		for (auto& material : m_scene.materials) {
 			ImGui::PushID(&material);
-			ImGui::ColorEdit3("Colour", glm::value_ptr(material.Albedo), 0.1f);
-			ImGui::DragFloat("Metallic", &material.Metallic, 0.01f, 0.0f, 1.0f);
-			ImGui::DragFloat("Roughness", &material.Roughness, 0.01f, 0.0f, 1.0f);
-
-			ImGui::ColorEdit3("Emission Color", glm::value_ptr(material.EmissionColor));
-			ImGui::DragFloat("Emission Power", &material.EmissionPower, 0.01f, 0.0f, FLT_MAX);
+			bool changed = ImGui::ColorEdit3("Colour", glm::value_ptr(material.Albedo), 0.1f);
+			changed |= ImGui::DragFloat("Metallic", &material.Metallic, 0.01f, 0.0f, 1.0f);
+			changed |= ImGui::DragFloat("Roughness", &material.Roughness, 0.01f, 0.0f, 1.0f);
+
+			changed |= ImGui::ColorEdit3("Emission Color", glm::value_ptr(material.EmissionColor));
+			changed |= ImGui::DragFloat("Emission Power", &material.EmissionPower, 0.01f, 0.0f, FLT_MAX);
+			if (changed)
+				m_scene.MarkMaterialsChanged();
 			ImGui::Separator();
 			ImGui::PopID();
 		}
@@ -121,9 +316,8 @@ public:
 		m_ViewportWidth = ImGui::GetContentRegionAvail().x;
 		m_ViewportHeight = ImGui::GetContentRegionAvail().y;
 
-		auto image = m_Renderer.GetFinalImage();
-		if (image)
-			ImGui::Image(image->GetDescriptorSet(), { (float)image->GetWidth(), (float)image->GetHeight()}, ImVec2(0, 1), ImVec2(1,0));
+		if (m_FinalImage)
+			ImGui::Image(m_FinalImage->GetDescriptorSet(), { (float)m_FinalImage->GetWidth(), (float)m_FinalImage->GetHeight()}, ImVec2(0, 1), ImVec2(1,0));
 
 		ImGui::End();
 		ImGui::PopStyleVar();
@@ -133,7 +327,21 @@ public:
 
 	virtual void OnUpdate(float ts) override
 	{
-		if (m_camera.OnUpdate(ts))
+		using namespace Walnut;
+
+		CameraInput input;
+		input.MousePosition = Input::GetMousePosition();
+		input.Look = Input::IsMouseButtonDown(MouseButton::Right);
+		input.Forward = Input::IsKeyDown(KeyCode::W);
+		input.Backward = Input::IsKeyDown(KeyCode::S);
+		input.Left = Input::IsKeyDown(KeyCode::A);
+		input.Right = Input::IsKeyDown(KeyCode::D);
+		input.Down = Input::IsKeyDown(KeyCode::Q);
+		input.Up = Input::IsKeyDown(KeyCode::E);
+		Input::SetCursorMode(input.Look ? CursorMode::Locked : CursorMode::Normal);
+
+		// With reprojection the renderer notices the move itself and keeps what still lines up
+		if (m_camera.OnUpdate(ts, input) && !m_Renderer.getSettings().TemporalReprojection)
 		{
 			m_Renderer.ResetFrameIndex();
 		}
@@ -145,6 +353,16 @@ public:
 		m_Renderer.OnResize(m_ViewportWidth, m_ViewportHeight);
 		m_camera.OnResize(m_ViewportWidth, m_ViewportHeight);
 		m_Renderer.Render(m_scene, m_camera);
+		m_StatsLog.Write(m_Renderer.GetFrameStats());
+
+		if (!m_FinalImage)
+			m_FinalImage = std::make_shared<Walnut::Image>(m_ViewportWidth, m_ViewportHeight, Walnut::ImageFormat::RGBA);
+		else if (m_FinalImage->GetWidth() != m_ViewportWidth || m_FinalImage->GetHeight() != m_ViewportHeight)
+			m_FinalImage->Resize(m_ViewportWidth, m_ViewportHeight);
+		{
+			RT_PROFILE_SCOPE("Image::SetData");
+			m_FinalImage->SetData(m_Renderer.GetImageData());
+		}
 
 		m_RenderTime = timer.ElapsedMillis();
 	}
@@ -152,9 +370,19 @@ public:
 private:
 	Camera m_camera;
 	Renderer m_Renderer;
+	std::shared_ptr<Walnut::Image> m_FinalImage;
 	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
 	Scene m_scene;
 	float m_RenderTime = 0;
+	char m_ModelPath[512] = "";
+	std::string m_ImportError;
+	char m_ScenePath[512] = "scene.rtscene";
+	std::string m_SceneError;
+	FrameStatsLog m_StatsLog;
+	char m_StatsLogPath[512] = "frame_stats.csv";
+	std::string m_StatsLogError;
+	char m_TracePath[512] = "trace.json";
+	std::string m_TraceError;
 };
 
 Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
@@ -177,64 +405,3 @@ Walnut::Application* Walnut::CreateApplication(int argc, char** argv)
 	});
 	return app;
 }
-
-Sphere createSphere() {
-	Sphere sphere;
-	sphere.Position = { 0.f,0.f,0.f };
-	sphere.Radius = 1.f;
-	sphere.MaterialIndex = 0;
-	return sphere;
-}
-
-Plane createPlane() {
-	Plane plane;
-	plane.Position = { 0.0f, 0.0f, 0.0f };
-	plane.Normal = { 0.0f, 1.0f, 0.0f };
-	plane.MaterialIndex = 0;
-	return plane;
-}
-
-Model createCube() {
-	std::vector<Triangle> cubeTriangles;
-
-	// Define the vertices of the cube
-	glm::vec3 vertices[8] = {
-		glm::vec3(-0.5, -0.5, -0.5),
-		glm::vec3(0.5, -0.5, -0.5),
-		glm::vec3(0.5, 0.5, -0.5),
-		glm::vec3(-0.5, 0.5, -0.5),
-		glm::vec3(-0.5, -0.5, 0.5),
-		glm::vec3(0.5, -0.5, 0.5),
-		glm::vec3(0.5, 0.5, 0.5),
-		glm::vec3(-0.5, 0.5, 0.5)
-	};
-
-	// Define the indices for the triangles that make up each face
-	int indices[6][6] = {
-		{0, 1, 2, 0, 2, 3}, // Front face
-		{1, 5, 6, 1, 6, 2}, // Right face
-		{5, 4, 7, 5, 7, 6}, // Back face
-		{4, 0, 3, 4, 3, 7}, // Left face
-		{3, 2, 6, 3, 6, 7}, // Top face
-		{4, 5, 1, 4, 1, 0}  // Bottom face
-	};
-
-	// Create triangles for each face
-	for (int i = 0; i < 6; i++) {
-		Triangle t1;
-		t1.points[0] = { vertices[indices[i][0]].x, vertices[indices[i][0]].y, vertices[indices[i][0]].z };
-		t1.points[1] = { vertices[indices[i][1]].x, vertices[indices[i][1]].y, vertices[indices[i][1]].z };
-		t1.points[2] = { vertices[indices[i][2]].x, vertices[indices[i][2]].y, vertices[indices[i][2]].z };
-
-		Triangle t2;
-		t2.points[0] = { vertices[indices[i][3]].x, vertices[indices[i][3]].y, vertices[indices[i][3]].z };
-		t2.points[1] = { vertices[indices[i][4]].x, vertices[indices[i][4]].y, vertices[indices[i][4]].z };
-		t2.points[2] = { vertices[indices[i][5]].x, vertices[indices[i][5]].y, vertices[indices[i][5]].z };
-
-		cubeTriangles.push_back(t1);
-		cubeTriangles.push_back(t2);
-	}
-
-	// Instantiate a Model object with the cube triangles
-	return Model(cubeTriangles, glm::vec3(0.0f, 0.0f, 0.0f), 0);
-}
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "Renderer.h"
+#include "Camera.h"
+#include "CompiledScene.h"
+#include "SceneFactory.h"
+#include "IntersectKernels.h"
+#include "Stats.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+struct Options
+{
+	std::vector<std::string> Scenes = { "default", "spheres", "mesh", "instances" };
+	std::string JsonPath;
+	uint32_t Width = 640, Height = 360;
+	uint32_t Bounces = 8;
+	float MinTime = 0.5f; // Seconds each benchmark repeats for
+};
+
+struct Result
+{
+	std::string Scene;
+	std::string Benchmark;
+	std::string SIMD;
+	uint32_t Threads = 1;
+	uint32_t Iterations = 0;
+	uint64_t Rays = 0;
+	double Seconds = 0.0;
+	TraceCounters Counters;
+	double Speedup = 1.0; // Versus the single thread run of the same benchmark
+
+	double NsPerRay() const { return Rays ? Seconds * 1e9 / (double)Rays : 0.0; }
+	double MraysPerSecond() const { return Seconds > 0.0 ? (double)Rays / Seconds * 1e-6 : 0.0; }
+	double NodeVisitsPerRay() const { return Rays ? (double)Counters.NodeVisits / (double)Rays : 0.0; }
+	double PrimitiveTestsPerRay() const { return Rays ? (double)Counters.PrimitiveTests / (double)Rays : 0.0; }
+};
+
+namespace Utils {
+	using Clock = std::chrono::steady_clock;
+
+	static double SecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	// Calls fn(), which handles rayCount rays, until at least minTime has passed and fills in the timing part of result
+	template<typename Fn>
+	static void Measure(float minTime, uint64_t rayCount, Result& result, Fn&& fn)
+	{
+		// Warm up caches and the thread pool outside of the timed region
+		fn();
+
+		ResetTraceCounters();
+		auto start = Clock::now();
+		do
+		{
+			fn();
+			result.Iterations++;
+		} while (SecondsSince(start) < minTime);
+
+		result.Seconds = SecondsSince(start);
+		result.Rays = rayCount * result.Iterations;
+		result.Counters = CollectTraceCounters();
+	}
+
+	static void PrintUsage()
+	{
+		std::printf(
+			"Usage: RaytracerBench [options]\n"
+			"  --scene <name>          Only run this scene, can be repeated: default, spheres, mesh or instances\n"
+			"  --width <pixels>        Image width (default: 640)\n"
+			"  --height <pixels>       Image height (default: 360)\n"
+			"  --bounces <count>       Maximum bounces for the render benchmark (default: 8)\n"
+			"  --min-time <seconds>    Minimum run time of each benchmark (default: 0.5)\n"
+			"  --json <path>           Write the results as JSON, - for stdout\n");
+	}
+
+	// Rejects signs, trailing characters and anything past UINT32_MAX rather than wrapping like atoi
+	static bool ParseUInt(const char* arg, const char* text, uint32_t& value)
+	{
+		errno = 0;
+		char* end = nullptr;
+		unsigned long parsed = std::isdigit((unsigned char)*text) ? std::strtoul(text, &end, 10) : 0;
+		if (!end || *end != '\0' || errno == ERANGE || parsed > UINT32_MAX)
+		{
+			std::fprintf(stderr, "Expected a whole number from 0 to %u for %s, got %s\n", UINT32_MAX, arg, text);
+			return false;
+		}
+		value = (uint32_t)parsed;
+		return true;
+	}
+
+	static bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		bool sceneGiven = false;
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				std::exit(0);
+			}
+
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "Missing value for %s\n", arg);
+				return false;
+			}
+			const char* value = argv[++i];
+
+			if (std::strcmp(arg, "--scene") == 0)
+			{
+				if (!sceneGiven)
+					options.Scenes.clear();
+				options.Scenes.push_back(value);
+				sceneGiven = true;
+			}
+			else if (std::strcmp(arg, "--width") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Width))
+					return false;
+			}
+			else if (std::strcmp(arg, "--height") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Height))
+					return false;
+			}
+			else if (std::strcmp(arg, "--bounces") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Bounces))
+					return false;
+			}
+			else if (std::strcmp(arg, "--min-time") == 0)
+				options.MinTime = (float)std::atof(value);
+			else if (std::strcmp(arg, "--json") == 0)
+				options.JsonPath = value;
+			else
+			{
+				std::fprintf(stderr, "Unknown option %s\n", arg);
+				return false;
+			}
+		}
+
+		if (options.Width == 0 || options.Height == 0)
+		{
+			std::fprintf(stderr, "Width and height must be positive\n");
+			return false;
+		}
+		return true;
+	}
+
+	// 1, 2, 4, ... up to and including the hardware thread count
+	static std::vector<uint32_t> GetThreadCounts()
+	{
+		uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<uint32_t> counts;
+		for (uint32_t count = 1; count < hardwareThreads; count *= 2)
+			counts.push_back(count);
+		counts.push_back(hardwareThreads);
+		return counts;
+	}
+
+	static void PrintResult(FILE* file, const Result& result)
+	{
+		std::fprintf(file, "%-8s %-16s %-14s %3u threads %9.2f ns/ray %8.2f Mrays/s %7.2f nodes/ray %7.2f tests/ray %5.2fx\n",
+			result.Scene.c_str(), result.Benchmark.c_str(), result.SIMD.c_str(), result.Threads, result.NsPerRay(),
+			result.MraysPerSecond(), result.NodeVisitsPerRay(), result.PrimitiveTestsPerRay(), result.Speedup);
+	}
+
+	static bool WriteJson(const std::string& path, const Options& options, const std::vector<Result>& results)
+	{
+		FILE* file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+		if (!file)
+			return false;
+
+		std::fprintf(file, "{\n");
+		std::fprintf(file, "  \"machine\": { \"hardware_threads\": %u, \"simd\": \"%s\" },\n",
+			std::max(std::thread::hardware_concurrency(), 1u), GetSIMDLevelName(GetSupportedSIMDLevel()));
+		std::fprintf(file, "  \"settings\": { \"width\": %u, \"height\": %u, \"bounces\": %u, \"min_time\": %g, \"stats\": %s },\n",
+			options.Width, options.Height, options.Bounces, options.MinTime, RT_STATS ? "true" : "false");
+		std::fprintf(file, "  \"results\": [\n");
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const Result& result = results[i];
+			std::fprintf(file,
+				"    { \"scene\": \"%s\", \"benchmark\": \"%s\", \"simd\": \"%s\", \"threads\": %u, \"iterations\": %u, "
+				"\"rays\": %llu, \"seconds\": %.6f, \"ns_per_ray\": %.3f, \"mrays_per_second\": %.3f, "
+				"\"node_visits_per_ray\": %.3f, \"primitive_tests_per_ray\": %.3f, \"speedup\": %.3f }%s\n",
+				result.Scene.c_str(), result.Benchmark.c_str(), result.SIMD.c_str(), result.Threads, result.Iterations,
+				(unsigned long long)result.Rays, result.Seconds, result.NsPerRay(), result.MraysPerSecond(),
+				result.NodeVisitsPerRay(), result.PrimitiveTestsPerRay(), result.Speedup, i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+
+		if (file != stdout)
+			std::fclose(file);
+		return true;
+	}
+}
+
+// Camera::GenerateRay for every pixel centre
+static Result BenchmarkCameraRays(const Options& options, const std::string& sceneName, const Camera& camera)
+{
+	Result result;
+	result.Scene = sceneName;
+	result.Benchmark = "camera_rays";
+	result.SIMD = "-";
+
+	volatile float sink = 0.0f;
+	Utils::Measure(options.MinTime, (uint64_t)options.Width * options.Height, result,
+		[&]()
+		{
+			float sum = 0.0f;
+			for (uint32_t y = 0; y < options.Height; y++)
+				for (uint32_t x = 0; x < options.Width; x++)
+					sum += camera.GenerateRay(x + 0.5f, y + 0.5f).Direction.x;
+			sink = sum;
+		});
+	return result;
+}
+
+// CompiledScene::Intersect for every camera ray on one thread, the closest-hit query behind Renderer::TraceRay
+static Result BenchmarkPrimaryRays(const Options& options, const std::string& sceneName, const Scene& scene, const Camera& camera, SIMDLevel level)
+{
+	SetIntersectKernels(level);
+	CompiledScene compiledScene;
+	compiledScene.Build(scene);
+
+	Result result;
+	result.Scene = sceneName;
+	result.Benchmark = "primary_rays";
+	result.SIMD = GetSIMDLevelName(level);
+
+	volatile uint32_t hitCount = 0;
+	Utils::Measure(options.MinTime, (uint64_t)options.Width * options.Height, result,
+		[&]()
+		{
+			uint32_t hits = 0;
+			for (uint32_t y = 0; y < options.Height; y++)
+			{
+				for (uint32_t x = 0; x < options.Width; x++)
+				{
+					HitRecord hit;
+					hits += compiledScene.Intersect(camera.GenerateRay(x + 0.5f, y + 0.5f), hit);
+				}
+			}
+			hitCount = hits;
+		});
+	return result;
+}
+
+// Full Renderer::Render frames (RayGen, TraceRay and bounces) at a given thread count, or through the wavefront
+// stages instead of RayGen
+static Result BenchmarkRender(const Options& options, const std::string& sceneName, const Scene& scene, const Camera& camera, uint32_t threads, bool wavefront = false)
+{
+	Renderer renderer;
+	renderer.getSettings().Accumulate = true;
+	renderer.getSettings().ThreadCount = threads;
+	renderer.getSettings().Wavefront = wavefront;
+	renderer.getBounces() = options.Bounces;
+	renderer.OnResize(options.Width, options.Height);
+
+	Result result;
+	result.Scene = sceneName;
+	result.Benchmark = wavefront ? "render_wavefront" : "render";
+	result.SIMD = GetSIMDLevelName(GetIntersectKernels().Level);
+	result.Threads = threads;
+
+	// The ray count of a frame depends on where paths terminate, so sum what the renderer reports
+	uint64_t rays = 0;
+	renderer.Render(scene, camera);
+	ResetTraceCounters();
+	auto start = Utils::Clock::now();
+	do
+	{
+		renderer.Render(scene, camera);
+		for (uint64_t threadRays : renderer.GetThreadRayCounts())
+			rays += threadRays;
+		result.Iterations++;
+	} while (Utils::SecondsSince(start) < options.MinTime);
+
+	result.Seconds = Utils::SecondsSince(start);
+	result.Rays = rays;
+	result.Counters = CollectTraceCounters();
+	return result;
+}
+
+// One object nudged through the scene's change tracking and CompiledScene::Update refitting around it, the
+// latency of an edit in the Scene panel. Each edit is counted as a ray, so ns/ray reads as ns per edit.
+static Result BenchmarkSceneEdit(const Options& options, const std::string& sceneName, Scene& scene)
+{
+	CompiledScene compiledScene;
+	compiledScene.Build(scene);
+
+	Result result;
+	result.Scene = sceneName;
+	result.Benchmark = "scene_edit";
+	result.SIMD = GetSIMDLevelName(GetIntersectKernels().Level);
+
+	// Objects move back and forth so the tree never loosens enough to be rebuilt
+	uint32_t edit = 0;
+	Utils::Measure(options.MinTime, 1, result,
+		[&]()
+		{
+			const size_t object = (size_t)edit * 7919 % scene.Objects.size();
+			scene.Objects[object]->Position.y += (edit / scene.Objects.size()) % 2 ? -0.01f : 0.01f;
+			scene.MarkObjectChanged(object);
+			compiledScene.Update(scene);
+			edit++;
+		});
+	return result;
+}
+
+// Per-primitive SceneObject::RayIntersect over a fixed set of rays aimed at the object
+static Result BenchmarkRayIntersect(const Options& options, const char* name, const SceneObject& object)
+{
+	std::vector<Ray> rays;
+	uint32_t seed = 7;
+	auto randomFloat = [&seed]() { seed = seed * 747796405u + 2891336453u; return (float)(seed >> 8) / (float)(1 << 24); };
+	for (uint32_t i = 0; i < 4096; i++)
+	{
+		glm::vec3 origin(randomFloat() * 8.0f - 4.0f, randomFloat() * 8.0f - 4.0f, 10.0f);
+		glm::vec3 target(randomFloat() * 4.0f - 2.0f, randomFloat() * 4.0f - 2.0f, 0.0f);
+		rays.push_back(Ray{ origin, glm::normalize(target - origin) });
+	}
+
+	Result result;
+	result.Scene = "-";
+	result.Benchmark = name;
+	result.SIMD = GetSIMDLevelName(GetIntersectKernels().Level);
+
+	volatile float distanceSum = 0.0f;
+	Utils::Measure(options.MinTime, rays.size(), result,
+		[&]()
+		{
+			float sum = 0.0f;
+			for (const Ray& ray : rays)
+				sum += object.RayIntersect(ray).HitDistance;
+			distanceSum = sum;
+		});
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!Utils::ParseOptions(argc, argv, options))
+	{
+		Utils::PrintUsage();
+		return 1;
+	}
+
+	// Keep stdout clean for the JSON when it goes there
+	FILE* log = options.JsonPath == "-" ? stderr : stdout;
+	std::vector<Result> results;
+	auto addResult = [&results, log](const Result& result)
+	{
+		Utils::PrintResult(log, result);
+		results.push_back(result);
+	};
+
+	const SIMDLevel supportedLevel = GetSupportedSIMDLevel();
+
+	{
+		Sphere sphere(glm::vec3(0.0f), 1.5f, 0);
+		Plane plane(glm::vec3(0.0f), glm::vec3(0.0f, 0.3f, 1.0f), 0);
+		Model mesh = createTorus(1.5f, 0.5f, 64);
+		addResult(BenchmarkRayIntersect(options, "sphere_intersect", sphere));
+		addResult(BenchmarkRayIntersect(options, "plane_intersect", plane));
+		addResult(BenchmarkRayIntersect(options, "mesh_intersect", mesh));
+	}
+
+	for (const std::string& sceneName : options.Scenes)
+	{
+		Scene scene;
+		if (!CreateSceneByName(sceneName, scene))
+		{
+			std::fprintf(stderr, "Unknown scene %s\n", sceneName.c_str());
+			return 1;
+		}
+
+		Camera camera(87.0f, 0.1f, 100.0f);
+		camera.OnResize(options.Width, options.Height);
+		camera.SetView(glm::vec3(0.0f, 0.0f, 6.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+
+		addResult(BenchmarkCameraRays(options, sceneName, camera));
+
+		for (int level = 0; level <= (int)supportedLevel; level++)
+			addResult(BenchmarkPrimaryRays(options, sceneName, scene, camera, (SIMDLevel)level));
+		SetIntersectKernels(supportedLevel);
+
+		double singleThreadNsPerRay = 0.0, allThreadsNsPerRay = 0.0;
+		for (uint32_t threads : Utils::GetThreadCounts())
+		{
+			Result result = BenchmarkRender(options, sceneName, scene, camera, threads);
+			if (threads == 1)
+				singleThreadNsPerRay = result.NsPerRay();
+			result.Speedup = result.NsPerRay() > 0.0 ? singleThreadNsPerRay / result.NsPerRay() : 1.0;
+			allThreadsNsPerRay = result.NsPerRay();
+			addResult(result);
+		}
+
+		// On every thread only, its speedup is over the depth-first render on as many threads. Russian roulette
+		// ends paths early, so compare ns/ray rather than frame times.
+		{
+			Result result = BenchmarkRender(options, sceneName, scene, camera, Utils::GetThreadCounts().back(), true);
+			result.Speedup = result.NsPerRay() > 0.0 ? allThreadsNsPerRay / result.NsPerRay() : 1.0;
+			addResult(result);
+		}
+
+		// Last, since it moves the objects
+		if (!scene.Objects.empty())
+			addResult(BenchmarkSceneEdit(options, sceneName, scene));
+	}
+
+	if (!options.JsonPath.empty() && !Utils::WriteJson(options.JsonPath, options, results))
+	{
+		std::fprintf(stderr, "Failed to write %s\n", options.JsonPath.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+project "RaytracerCLI"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "off"
+
+   files { "src/**.h", "src/**.cpp" }
+
+   includedirs
+   {
+      "../Walnut/vendor/glm",
+
+      "../RaytracerCore/src",
+   }
+
+   links
+   {
+       "RaytracerCore"
+   }
+
+   targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+   filter "system:windows"
+      systemversion "latest"
+
+   filter "system:linux"
+      links { "pthread" }
+
+   filter "configurations:Debug"
+      defines { "WL_DEBUG" }
+      runtime "Debug"
+      symbols "On"
+
+   filter "configurations:Release"
+      defines { "WL_RELEASE" }
+      runtime "Release"
+      optimize "On"
+      symbols "On"
+
+   filter "configurations:Dist"
+      defines { "WL_DIST" }
+      runtime "Release"
+      optimize "On"
+      symbols "Off"
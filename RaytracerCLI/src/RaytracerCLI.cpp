@@ -0,0 +1,481 @@
+#include "Renderer.h"
+#include "Camera.h"
+#include "SceneFactory.h"
+#include "ImageIO.h"
+#include "MeshLoader.h"
+#include "SceneIO.h"
+#include "Profiler.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+struct Options
+{
+	std::string ScenePath = "default";
+	std::string OutputPath = "render.exr";
+	std::string SaveScenePath;
+	std::string StatsPath;
+	std::string TracePath;
+	std::string ModelPath;
+	glm::vec3 ModelPosition{ 0.0f };
+	int ModelMaterial = 0;
+	uint32_t Width = 1280, Height = 720;
+	uint32_t SamplesPerPixel = 64;
+	uint32_t Bounces = 8;
+	uint32_t ThreadCount = 0;
+	uint32_t TileSize = 32;
+	bool PacketTracing = false;
+	bool Wavefront = false;
+
+	float VerticalFOV = 87.0f;
+	float Aperture = 0.0f;
+	float FocusDistance = 6.0f;
+	bool Jitter = true;
+	SamplerType Sampler = SamplerType::Sobol;
+	bool NextEventEstimation = true;
+	float NoiseThreshold = 0.0f;
+	bool Denoise = false;
+	float Exposure = 0.0f;
+	ToneMapOperator ToneMap = ToneMapOperator::Clamp;
+	bool SRGB = false;
+	bool WriteAOVs = false;
+	uint32_t MinSamples = 16;
+	glm::vec3 CameraPosition{ 0.0f, 0.0f, 6.0f };
+	glm::vec3 CameraDirection{ 0.0f, 0.0f, -1.0f };
+};
+
+namespace Utils {
+	static void PrintUsage()
+	{
+		std::printf(
+			"Usage: RaytracerCLI [options]\n"
+			"  --scene <name|path>     Scene to render: default, spheres, mesh, instances or a .rtscene or .json file (default: default)\n"
+			"  --save-scene <path>     Write the scene, with any imported mesh, to a .rtscene or .json file\n"
+			"  --output <path>         Output image, .exr, .pfm or .ppm (default: render.exr)\n"
+			"  --model <path>          Add an .obj or .ply mesh to the scene\n"
+			"  --model-position <x,y,z> Position of the imported mesh (default: 0,0,0)\n"
+			"  --model-material <index> Material of the imported mesh (default: 0)\n"
+			"  --width <pixels>        Image width (default: 1280)\n"
+			"  --height <pixels>       Image height (default: 720)\n"
+			"  --spp <samples>         Samples per pixel, the maximum with --noise-threshold (default: 64)\n"
+			"  --noise-threshold <e>   Stop sampling pixels whose standard error drops below e (default: off)\n"
+			"  --min-spp <samples>     Samples before a pixel may stop with --noise-threshold (default: 16)\n"
+			"  --bounces <count>       Maximum bounces per path (default: 8)\n"
+			"  --threads <count>       Render threads, 0 uses every core (default: 0)\n"
+			"  --tile <pixels>         Tile size (default: 32)\n"
+			"  --packets               Trace primary rays as packets\n"
+			"  --wavefront             Trace tiles as wavefronts of paths with Russian roulette\n"
+			"  --fov <degrees>         Vertical field of view (default: 87)\n"
+			"  --camera <x,y,z>        Camera position (default: 0,0,6)\n"
+			"  --direction <x,y,z>     Camera forward direction (default: 0,0,-1)\n"
+			"  --aperture <size>       Lens diameter for depth of field, 0 is a pinhole (default: 0)\n"
+			"  --focus <distance>      Distance of the plane in focus (default: 6)\n"
+			"  --no-jitter             Trace every sample through the pixel centre\n"
+			"  --sampler <name>        Sample sequence: random, sobol or bluenoise (default: sobol)\n"
+			"  --no-light-sampling     Only find emitters by bouncing into them\n"
+			"  --denoise               Write the output through the edge-aware denoiser\n"
+			"  --exposure <ev>         Exposure in stops for .ppm output (default: 0)\n"
+			"  --tonemap <name>        Tone curve for .ppm output: clamp, reinhard or aces (default: clamp)\n"
+			"  --srgb                  Encode .ppm output with the sRGB curve\n"
+			"  --aovs                  Also write the albedo, normal and depth AOVs next to the output\n"
+			"  --stats <path>          Log the timings and trace counters of every sample, .csv or JSON Lines\n"
+			"  --trace <path>          Write a timeline of the render as Chrome trace_event JSON\n");
+	}
+
+	// render.exr -> render.albedo.exr
+	static std::string GetAOVPath(const std::string& outputPath, const char* name)
+	{
+		size_t dot = outputPath.find_last_of('.');
+		if (dot == std::string::npos)
+			return outputPath + "." + name;
+		return outputPath.substr(0, dot) + "." + name + outputPath.substr(dot);
+	}
+
+	static bool ParseVec3(const char* text, glm::vec3& value)
+	{
+		return std::sscanf(text, "%f,%f,%f", &value.x, &value.y, &value.z) == 3;
+	}
+
+	// Whole decimal number that fits a uint32_t. atoi would read "-1" as 4294967295 and "abc" or "12px" without complaint
+	static bool ParseUInt(const char* arg, const char* text, uint32_t& value)
+	{
+		errno = 0;
+		char* end = nullptr;
+		unsigned long parsed = std::isdigit((unsigned char)*text) ? std::strtoul(text, &end, 10) : 0;
+		if (!end || *end != '\0' || errno == ERANGE || parsed > UINT32_MAX)
+		{
+			std::fprintf(stderr, "Expected a whole number from 0 to %u for %s, got %s\n", UINT32_MAX, arg, text);
+			return false;
+		}
+		value = (uint32_t)parsed;
+		return true;
+	}
+
+	static bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+			{
+				PrintUsage();
+				std::exit(0);
+			}
+			if (std::strcmp(arg, "--packets") == 0)
+			{
+				options.PacketTracing = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--wavefront") == 0)
+			{
+				options.Wavefront = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--no-jitter") == 0)
+			{
+				options.Jitter = false;
+				continue;
+			}
+			if (std::strcmp(arg, "--no-light-sampling") == 0)
+			{
+				options.NextEventEstimation = false;
+				continue;
+			}
+			if (std::strcmp(arg, "--denoise") == 0)
+			{
+				options.Denoise = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--srgb") == 0)
+			{
+				options.SRGB = true;
+				continue;
+			}
+			if (std::strcmp(arg, "--aovs") == 0)
+			{
+				options.WriteAOVs = true;
+				continue;
+			}
+
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "Missing value for %s\n", arg);
+				return false;
+			}
+			const char* value = argv[++i];
+
+			if (std::strcmp(arg, "--scene") == 0)
+				options.ScenePath = value;
+			else if (std::strcmp(arg, "--save-scene") == 0)
+				options.SaveScenePath = value;
+			else if (std::strcmp(arg, "--stats") == 0)
+				options.StatsPath = value;
+			else if (std::strcmp(arg, "--trace") == 0)
+				options.TracePath = value;
+			else if (std::strcmp(arg, "--output") == 0 || std::strcmp(arg, "-o") == 0)
+				options.OutputPath = value;
+			else if (std::strcmp(arg, "--model") == 0)
+				options.ModelPath = value;
+			else if (std::strcmp(arg, "--model-position") == 0)
+			{
+				if (!ParseVec3(value, options.ModelPosition))
+				{
+					std::fprintf(stderr, "Expected x,y,z for --model-position\n");
+					return false;
+				}
+			}
+			else if (std::strcmp(arg, "--model-material") == 0)
+				options.ModelMaterial = std::atoi(value);
+			else if (std::strcmp(arg, "--width") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Width))
+					return false;
+			}
+			else if (std::strcmp(arg, "--height") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Height))
+					return false;
+			}
+			else if (std::strcmp(arg, "--spp") == 0)
+			{
+				if (!ParseUInt(arg, value, options.SamplesPerPixel))
+					return false;
+			}
+			else if (std::strcmp(arg, "--noise-threshold") == 0)
+				options.NoiseThreshold = (float)std::atof(value);
+			else if (std::strcmp(arg, "--min-spp") == 0)
+			{
+				if (!ParseUInt(arg, value, options.MinSamples))
+					return false;
+			}
+			else if (std::strcmp(arg, "--bounces") == 0)
+			{
+				if (!ParseUInt(arg, value, options.Bounces))
+					return false;
+			}
+			else if (std::strcmp(arg, "--threads") == 0)
+			{
+				if (!ParseUInt(arg, value, options.ThreadCount))
+					return false;
+			}
+			else if (std::strcmp(arg, "--tile") == 0)
+			{
+				if (!ParseUInt(arg, value, options.TileSize))
+					return false;
+			}
+			else if (std::strcmp(arg, "--exposure") == 0)
+				options.Exposure = (float)std::atof(value);
+			else if (std::strcmp(arg, "--tonemap") == 0)
+			{
+				if (std::strcmp(value, "clamp") == 0)
+					options.ToneMap = ToneMapOperator::Clamp;
+				else if (std::strcmp(value, "reinhard") == 0)
+					options.ToneMap = ToneMapOperator::Reinhard;
+				else if (std::strcmp(value, "aces") == 0)
+					options.ToneMap = ToneMapOperator::ACES;
+				else
+				{
+					std::fprintf(stderr, "Unknown tone curve %s, expected clamp, reinhard or aces\n", value);
+					return false;
+				}
+			}
+			else if (std::strcmp(arg, "--sampler") == 0)
+			{
+				if (std::strcmp(value, "random") == 0)
+					options.Sampler = SamplerType::Random;
+				else if (std::strcmp(value, "sobol") == 0)
+					options.Sampler = SamplerType::Sobol;
+				else if (std::strcmp(value, "bluenoise") == 0)
+					options.Sampler = SamplerType::BlueNoise;
+				else
+				{
+					std::fprintf(stderr, "Unknown sampler %s, expected random, sobol or bluenoise\n", value);
+					return false;
+				}
+			}
+			else if (std::strcmp(arg, "--fov") == 0)
+				options.VerticalFOV = (float)std::atof(value);
+			else if (std::strcmp(arg, "--aperture") == 0)
+				options.Aperture = (float)std::atof(value);
+			else if (std::strcmp(arg, "--focus") == 0)
+				options.FocusDistance = (float)std::atof(value);
+			else if (std::strcmp(arg, "--camera") == 0)
+			{
+				if (!ParseVec3(value, options.CameraPosition))
+				{
+					std::fprintf(stderr, "Expected x,y,z for --camera\n");
+					return false;
+				}
+			}
+			else if (std::strcmp(arg, "--direction") == 0)
+			{
+				if (!ParseVec3(value, options.CameraDirection))
+				{
+					std::fprintf(stderr, "Expected x,y,z for --direction\n");
+					return false;
+				}
+			}
+			else
+			{
+				std::fprintf(stderr, "Unknown option %s\n", arg);
+				return false;
+			}
+		}
+
+		if (options.Width == 0 || options.Height == 0 || options.SamplesPerPixel == 0)
+		{
+			std::fprintf(stderr, "Width, height and spp must be positive\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!Utils::ParseOptions(argc, argv, options))
+	{
+		Utils::PrintUsage();
+		return 1;
+	}
+
+	Scene scene;
+	if (IsSceneFile(options.ScenePath))
+	{
+		std::string error;
+		auto start = std::chrono::steady_clock::now();
+		if (!LoadScene(options.ScenePath, scene, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::fprintf(stderr, "Loaded %s: %zu objects in %.1f ms\n", options.ScenePath.c_str(), scene.Objects.size(), milliseconds);
+	}
+	else if (!CreateSceneByName(options.ScenePath, scene))
+	{
+		std::fprintf(stderr, "Unknown scene %s\n", options.ScenePath.c_str());
+		return 1;
+	}
+
+	if (!options.ModelPath.empty())
+	{
+		auto mesh = std::make_shared<Mesh>();
+		std::string error;
+		auto start = std::chrono::steady_clock::now();
+		if (!LoadMesh(options.ModelPath, *mesh, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::fprintf(stderr, "Loaded %s: %zu triangles in %.1f ms\n", options.ModelPath.c_str(), mesh->GetTriangleCount(), milliseconds);
+
+		if (options.ModelMaterial < 0 || options.ModelMaterial >= (int)scene.materials.size())
+		{
+			std::fprintf(stderr, "Material %d does not exist in the scene\n", options.ModelMaterial);
+			return 1;
+		}
+		scene.Objects.push_back(std::make_unique<Model>(std::move(mesh), options.ModelPosition, options.ModelMaterial));
+	}
+
+	if (!options.SaveScenePath.empty())
+	{
+		std::string error;
+		if (!SaveScene(options.SaveScenePath, scene, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		std::printf("Wrote %s\n", options.SaveScenePath.c_str());
+	}
+
+	Camera camera(options.VerticalFOV, 0.1f, 100.0f);
+	*camera.getAperture() = options.Aperture;
+	*camera.getFocusDistance() = options.FocusDistance;
+	camera.OnResize(options.Width, options.Height);
+	camera.SetView(options.CameraPosition, options.CameraDirection);
+
+	Renderer renderer;
+	renderer.getSettings().Accumulate = true;
+	// The output is written from the accumulation, so the display image is never needed
+	renderer.getSettings().ResolveEveryFrame = false;
+	renderer.getSettings().PacketTracing = options.PacketTracing;
+	renderer.getSettings().Wavefront = options.Wavefront;
+	renderer.getSettings().ThreadCount = options.ThreadCount;
+	renderer.getSettings().TileSize = options.TileSize;
+	renderer.getSettings().Jitter = options.Jitter;
+	renderer.getSettings().Sampler = options.Sampler;
+	renderer.getSettings().NextEventEstimation = options.NextEventEstimation;
+	renderer.getSettings().AdaptiveSampling = options.NoiseThreshold > 0.0f;
+	renderer.getSettings().NoiseThreshold = options.NoiseThreshold;
+	renderer.getSettings().MinSamples = options.MinSamples;
+	renderer.getBounces() = options.Bounces;
+	Tonemapper& tonemapper = renderer.GetTonemapper();
+	tonemapper.GetSettings().Exposure = options.Exposure;
+	tonemapper.GetSettings().Operator = options.ToneMap;
+	tonemapper.GetSettings().SRGB = options.SRGB;
+	tonemapper.Update();
+	renderer.OnResize(options.Width, options.Height);
+
+	FrameStatsLog statsLog;
+	if (!options.StatsPath.empty())
+	{
+		std::string error;
+		if (!statsLog.Open(options.StatsPath, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+	}
+
+	if (!options.TracePath.empty())
+	{
+		SetProfilerThreadName("Main");
+		SetProfilerEnabled(true);
+	}
+
+	const size_t pixelCount = (size_t)options.Width * options.Height;
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t sample = 0; sample < options.SamplesPerPixel; sample++)
+	{
+		renderer.Render(scene, camera);
+		statsLog.Write(renderer.GetFrameStats());
+		std::fprintf(stderr, "\rSample %u/%u, %.2f Mrays/s, %.1f%% of pixels active", sample + 1, options.SamplesPerPixel,
+			renderer.GetMraysPerSecond(), 100.0f * renderer.GetActivePixelCount() / pixelCount);
+		if (renderer.GetActivePixelCount() == 0)
+			break;
+	}
+	float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+	const uint32_t* sampleCounts = renderer.GetSampleCountData();
+	uint64_t totalSamples = 0;
+	for (size_t i = 0; i < pixelCount; i++)
+		totalSamples += sampleCounts[i];
+	std::fprintf(stderr, "\nRendered %ux%u at %.1f spp on average in %.2f s\n", options.Width, options.Height,
+		(double)totalSamples / pixelCount, seconds);
+
+	if (options.Denoise)
+	{
+		renderer.Denoise();
+		std::fprintf(stderr, "Denoised in %.1f ms\n", renderer.GetDenoiseMs());
+	}
+
+	if (!options.TracePath.empty())
+	{
+		SetProfilerEnabled(false);
+		std::string error;
+		if (!WriteChromeTrace(options.TracePath, error))
+		{
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		std::printf("Wrote %s\n", options.TracePath.c_str());
+	}
+
+	// Averages a per-pixel sum into linear RGB, adaptive sampling leaves every pixel with its own count. Only the
+	// beauty image is tone mapped, the AOVs are data.
+	std::vector<float> rgb(pixelCount * 3);
+	auto writeImage = [&](const std::string& path, auto getValue, bool divideBySamples, const Tonemapper* imageTonemapper = nullptr)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			const float scale = divideBySamples ? 1.0f / (float)std::max(sampleCounts[i], 1u) : 1.0f;
+			const glm::vec3 value = getValue(i);
+			rgb[i * 3 + 0] = value.r * scale;
+			rgb[i * 3 + 1] = value.g * scale;
+			rgb[i * 3 + 2] = value.b * scale;
+		}
+
+		if (!WriteImage(path, rgb.data(), options.Width, options.Height, imageTonemapper))
+		{
+			std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+			return false;
+		}
+		std::printf("Wrote %s\n", path.c_str());
+		return true;
+	};
+
+	bool written;
+	if (options.Denoise)
+		written = writeImage(options.OutputPath, [&](size_t i) { return renderer.GetDenoisedData()[i]; }, false, &tonemapper);
+	else
+		written = writeImage(options.OutputPath, [&](size_t i) { return glm::vec3(renderer.GetAccumulationData()[i]); }, true, &tonemapper);
+
+	if (written && options.WriteAOVs)
+	{
+		written = writeImage(Utils::GetAOVPath(options.OutputPath, "albedo"), [&](size_t i) { return renderer.GetAlbedoData()[i]; }, true)
+			&& writeImage(Utils::GetAOVPath(options.OutputPath, "normal"), [&](size_t i) { return renderer.GetNormalData()[i]; }, true)
+			&& writeImage(Utils::GetAOVPath(options.OutputPath, "depth"), [&](size_t i) { return glm::vec3(renderer.GetDepthData()[i]); }, true);
+	}
+	return written ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+project "RaytracerCore"
+   kind "StaticLib"
+   language "C++"
+   cppdialect "C++17"
+   staticruntime "off"
+
+   files { "src/**.h", "src/**.cpp" }
+
+   -- glm is header only, the core does not depend on anything else from Walnut
+   includedirs
+   {
+      "../Walnut/vendor/glm",
+   }
+
+   targetdir ("../bin/" .. outputdir .. "/%{prj.name}")
+   objdir ("../bin-int/" .. outputdir .. "/%{prj.name}")
+
+   filter "system:windows"
+      systemversion "latest"
+
+   filter "configurations:Debug"
+      defines { "WL_DEBUG" }
+      runtime "Debug"
+      symbols "On"
+
+   filter "configurations:Release"
+      defines { "WL_RELEASE" }
+      runtime "Release"
+      optimize "On"
+      symbols "On"
+
+   filter "configurations:Dist"
+      defines { "WL_DIST" }
+      runtime "Release"
+      optimize "On"
+      symbols "Off"
@@ -0,0 +1,284 @@
+#include "BVH.h"
+
+#include <chrono>
+#include <algorithm>
+
+namespace {
+	constexpr uint32_t BinCount = 16;
+	constexpr float TraversalCost = 1.0f;
+	constexpr float IntersectionCost = 1.0f;
+
+	struct Bin
+	{
+		AABB Bounds;
+		uint32_t Count = 0;
+	};
+}
+
+void BVH::Build(const std::vector<AABB>& primitiveBounds, uint32_t maxLeafSize, uint32_t batchWidth)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	m_Nodes.clear();
+	m_Parents.clear();
+	m_PrimitiveLeaves.clear();
+	m_PrimitiveIndices.resize(primitiveBounds.size());
+	m_MaxLeafSize = std::max(maxLeafSize, 1u);
+	m_BatchWidth = std::max(batchWidth, 1u);
+	m_Stats = BVHStats{};
+	m_BuildSAHCost = 0.0f;
+	m_CostSum = 0.0;
+
+	if (primitiveBounds.empty())
+		return;
+
+	std::vector<glm::vec3> centroids(primitiveBounds.size());
+	for (size_t i = 0; i < primitiveBounds.size(); i++)
+	{
+		m_PrimitiveIndices[i] = (uint32_t)i;
+		centroids[i] = primitiveBounds[i].Centroid();
+	}
+
+	// A binary tree over N primitives never needs more than 2N - 1 nodes
+	m_Nodes.reserve(primitiveBounds.size() * 2 - 1);
+	BVHNode& root = m_Nodes.emplace_back();
+	root.LeftFirst = 0;
+	root.Count = (uint32_t)primitiveBounds.size();
+	UpdateNodeBounds(root, primitiveBounds);
+	Subdivide(0, 1, primitiveBounds, centroids);
+
+	m_Nodes.shrink_to_fit();
+	CalculateStats();
+	m_Stats.BuildTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void BVH::Assign(std::vector<BVHNode> nodes, std::vector<uint32_t> primitiveIndices, uint32_t maxLeafSize, uint32_t batchWidth)
+{
+	m_Nodes = std::move(nodes);
+	m_PrimitiveIndices = std::move(primitiveIndices);
+	m_Parents.clear();
+	m_PrimitiveLeaves.clear();
+	m_MaxLeafSize = std::max(maxLeafSize, 1u);
+	m_BatchWidth = std::max(batchWidth, 1u);
+	m_Stats = BVHStats{};
+	m_BuildSAHCost = 0.0f;
+	m_CostSum = 0.0;
+	if (!m_Nodes.empty())
+		CalculateStats();
+}
+
+void BVH::Refit(const std::vector<AABB>& primitiveBounds, const std::vector<uint32_t>& changedPrimitives)
+{
+	if (m_Nodes.empty() || changedPrimitives.empty())
+		return;
+
+	if (m_Parents.empty())
+	{
+		m_Parents.assign(m_Nodes.size(), 0);
+		m_PrimitiveLeaves.assign(m_PrimitiveIndices.size(), 0);
+		for (uint32_t i = 0; i < (uint32_t)m_Nodes.size(); i++)
+		{
+			const BVHNode& node = m_Nodes[i];
+			if (node.IsLeaf())
+			{
+				for (uint32_t j = 0; j < node.Count; j++)
+					m_PrimitiveLeaves[m_PrimitiveIndices[node.LeftFirst + j]] = i;
+			}
+			else
+			{
+				m_Parents[node.LeftFirst] = i;
+				m_Parents[node.LeftFirst + 1] = i;
+			}
+		}
+	}
+
+	for (uint32_t primitive : changedPrimitives)
+	{
+		// Walk up from the leaf until a node's bounds come out unchanged, nothing above it can change either
+		uint32_t nodeIndex = m_PrimitiveLeaves[primitive];
+		while (true)
+		{
+			BVHNode& node = m_Nodes[nodeIndex];
+			AABB bounds;
+			if (node.IsLeaf())
+			{
+				for (uint32_t i = 0; i < node.Count; i++)
+					bounds.Grow(primitiveBounds[m_PrimitiveIndices[node.LeftFirst + i]]);
+			}
+			else
+			{
+				bounds = m_Nodes[node.LeftFirst].Bounds;
+				bounds.Grow(m_Nodes[node.LeftFirst + 1].Bounds);
+			}
+
+			if (bounds.Min == node.Bounds.Min && bounds.Max == node.Bounds.Max)
+				break;
+
+			m_CostSum -= GetNodeCost(node);
+			node.Bounds = bounds;
+			m_CostSum += GetNodeCost(node);
+			if (nodeIndex == 0)
+				break;
+			nodeIndex = m_Parents[nodeIndex];
+		}
+	}
+
+	float rootArea = m_Nodes[0].Bounds.SurfaceArea();
+	m_Stats.SAHCost = rootArea > 0.0f ? (float)(m_CostSum / rootArea) : 0.0f;
+}
+
+float BVH::GetNodeCost(const BVHNode& node) const
+{
+	float cost = node.IsLeaf() ? IntersectionCost * BatchCount(node.Count) : TraversalCost;
+	return node.Bounds.SurfaceArea() * cost;
+}
+
+void BVH::UpdateNodeBounds(BVHNode& node, const std::vector<AABB>& primitiveBounds) const
+{
+	node.Bounds = AABB{};
+	for (uint32_t i = 0; i < node.Count; i++)
+		node.Bounds.Grow(primitiveBounds[m_PrimitiveIndices[node.LeftFirst + i]]);
+}
+
+bool BVH::FindSplit(const BVHNode& node, const std::vector<AABB>& primitiveBounds, const std::vector<glm::vec3>& centroids, int& axis, float& splitPosition, float& cost) const
+{
+	AABB centroidBounds;
+	for (uint32_t i = 0; i < node.Count; i++)
+		centroidBounds.Grow(centroids[m_PrimitiveIndices[node.LeftFirst + i]]);
+
+	cost = FLT_MAX;
+	for (int a = 0; a < 3; a++)
+	{
+		float boundsMin = centroidBounds.Min[a];
+		float boundsMax = centroidBounds.Max[a];
+		if (boundsMin == boundsMax)
+			continue;
+
+		Bin bins[BinCount];
+		float scale = BinCount / (boundsMax - boundsMin);
+		for (uint32_t i = 0; i < node.Count; i++)
+		{
+			uint32_t primitive = m_PrimitiveIndices[node.LeftFirst + i];
+			uint32_t binIndex = std::min(BinCount - 1, (uint32_t)((centroids[primitive][a] - boundsMin) * scale));
+			bins[binIndex].Count++;
+			bins[binIndex].Bounds.Grow(primitiveBounds[primitive]);
+		}
+
+		// Sweep from both sides to get the area and count on either side of every bin boundary
+		float leftArea[BinCount - 1], rightArea[BinCount - 1];
+		uint32_t leftCount[BinCount - 1], rightCount[BinCount - 1];
+		AABB leftBox, rightBox;
+		uint32_t leftSum = 0, rightSum = 0;
+		for (uint32_t i = 0; i < BinCount - 1; i++)
+		{
+			leftSum += bins[i].Count;
+			leftCount[i] = leftSum;
+			leftBox.Grow(bins[i].Bounds);
+			leftArea[i] = leftBox.SurfaceArea();
+
+			rightSum += bins[BinCount - 1 - i].Count;
+			rightCount[BinCount - 2 - i] = rightSum;
+			rightBox.Grow(bins[BinCount - 1 - i].Bounds);
+			rightArea[BinCount - 2 - i] = rightBox.SurfaceArea();
+		}
+
+		for (uint32_t i = 0; i < BinCount - 1; i++)
+		{
+			if (leftCount[i] == 0 || rightCount[i] == 0)
+				continue;
+
+			float planeCost = BatchCount(leftCount[i]) * leftArea[i] + BatchCount(rightCount[i]) * rightArea[i];
+			if (planeCost < cost)
+			{
+				axis = a;
+				splitPosition = boundsMin + (i + 1) / scale;
+				cost = planeCost;
+			}
+		}
+	}
+
+	if (cost == FLT_MAX)
+		return false;
+
+	// Normalize into the same units as the leaf cost
+	cost = TraversalCost + IntersectionCost * cost / node.Bounds.SurfaceArea();
+	return true;
+}
+
+void BVH::Subdivide(uint32_t nodeIndex, uint32_t depth, const std::vector<AABB>& primitiveBounds, const std::vector<glm::vec3>& centroids)
+{
+	BVHNode& node = m_Nodes[nodeIndex];
+	if (node.Count <= 1 || depth >= MaxDepth)
+		return;
+
+	int axis = 0;
+	float splitPosition = 0.0f, splitCost = 0.0f;
+	if (!FindSplit(node, primitiveBounds, centroids, axis, splitPosition, splitCost))
+		return;
+
+	float leafCost = IntersectionCost * BatchCount(node.Count);
+	if (splitCost >= leafCost && node.Count <= m_MaxLeafSize)
+		return;
+
+	// Partition the primitive indices in place around the split plane
+	uint32_t first = node.LeftFirst;
+	uint32_t* begin = m_PrimitiveIndices.data() + first;
+	uint32_t* middle = std::partition(begin, begin + node.Count,
+		[&](uint32_t primitive) { return centroids[primitive][axis] < splitPosition; });
+	uint32_t leftCount = (uint32_t)(middle - begin);
+	if (leftCount == 0 || leftCount == node.Count)
+		return;
+
+	uint32_t leftChild = (uint32_t)m_Nodes.size();
+	m_Nodes.emplace_back();
+	m_Nodes.emplace_back();
+
+	// emplace_back never reallocates thanks to the reserve in Build, but index through m_Nodes to be safe
+	m_Nodes[leftChild].LeftFirst = first;
+	m_Nodes[leftChild].Count = leftCount;
+	m_Nodes[leftChild + 1].LeftFirst = first + leftCount;
+	m_Nodes[leftChild + 1].Count = m_Nodes[nodeIndex].Count - leftCount;
+	UpdateNodeBounds(m_Nodes[leftChild], primitiveBounds);
+	UpdateNodeBounds(m_Nodes[leftChild + 1], primitiveBounds);
+
+	m_Nodes[nodeIndex].LeftFirst = leftChild;
+	m_Nodes[nodeIndex].Count = 0;
+
+	Subdivide(leftChild, depth + 1, primitiveBounds, centroids);
+	Subdivide(leftChild + 1, depth + 1, primitiveBounds, centroids);
+}
+
+void BVH::CalculateStats()
+{
+	m_Stats.PrimitiveCount = (uint32_t)m_PrimitiveIndices.size();
+	m_Stats.NodeCount = (uint32_t)m_Nodes.size();
+
+	float rootArea = m_Nodes[0].Bounds.SurfaceArea();
+	float inverseRootArea = rootArea > 0.0f ? 1.0f / rootArea : 0.0f;
+
+	struct Entry { uint32_t Node, Depth; };
+	std::vector<Entry> stack{ { 0, 1 } };
+	while (!stack.empty())
+	{
+		Entry entry = stack.back();
+		stack.pop_back();
+
+		const BVHNode& node = m_Nodes[entry.Node];
+		m_CostSum += GetNodeCost(node);
+		m_Stats.MaxDepth = std::max(m_Stats.MaxDepth, entry.Depth);
+		if (node.IsLeaf())
+		{
+			m_Stats.LeafCount++;
+			m_Stats.MaxLeafSize = std::max(m_Stats.MaxLeafSize, node.Count);
+		}
+		else
+		{
+			stack.push_back({ node.LeftFirst, entry.Depth + 1 });
+			stack.push_back({ node.LeftFirst + 1, entry.Depth + 1 });
+		}
+	}
+
+	m_Stats.SAHCost = (float)(m_CostSum * inverseRootArea);
+	m_BuildSAHCost = m_Stats.SAHCost;
+	m_Stats.AverageLeafSize = m_Stats.LeafCount ? (float)m_Stats.PrimitiveCount / m_Stats.LeafCount : 0.0f;
+}
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <utility>
+
+#include "Ray.h"
+#include "RayPacket.h"
+#include "Stats.h"
+
+struct AABB
+{
+	glm::vec3 Min{ FLT_MAX };
+	glm::vec3 Max{ -FLT_MAX };
+
+	void Grow(const glm::vec3& point)
+	{
+		Min = glm::min(Min, point);
+		Max = glm::max(Max, point);
+	}
+
+	void Grow(const AABB& other)
+	{
+		Min = glm::min(Min, other.Min);
+		Max = glm::max(Max, other.Max);
+	}
+
+	bool IsValid() const { return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z; }
+	glm::vec3 Centroid() const { return (Min + Max) * 0.5f; }
+
+	float SurfaceArea() const
+	{
+		if (!IsValid())
+			return 0.0f;
+		glm::vec3 e = Max - Min;
+		return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+	}
+
+	// Slab test, returns the entry distance or FLT_MAX when the box is missed or further than maxDistance
+	float Intersect(const Ray& ray, const glm::vec3& invDirection, float maxDistance) const
+	{
+		glm::vec3 t0 = (Min - ray.Origin) * invDirection;
+		glm::vec3 t1 = (Max - ray.Origin) * invDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+
+		float tEnter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		float tExit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		return tEnter <= tExit ? tEnter : FLT_MAX;
+	}
+
+	// Slab test for every ray of a packet, returns the subset of mask whose rays enter the box before their closest hit
+	RayMask Intersect(const RayPacket& packet, const float* closestHits, RayMask mask) const
+	{
+		glm::vec3 min = Min - packet.Origin;
+		glm::vec3 max = Max - packet.Origin;
+
+		RayMask hits = 0;
+		for (uint32_t i = 0; i < packet.Size; i++)
+		{
+			float tx0 = min.x * packet.InvDirectionX[i], tx1 = max.x * packet.InvDirectionX[i];
+			float ty0 = min.y * packet.InvDirectionY[i], ty1 = max.y * packet.InvDirectionY[i];
+			float tz0 = min.z * packet.InvDirectionZ[i], tz1 = max.z * packet.InvDirectionZ[i];
+
+			float tEnter = glm::max(glm::max(glm::min(tx0, tx1), glm::min(ty0, ty1)), glm::max(glm::min(tz0, tz1), 0.0f));
+			float tExit = glm::min(glm::min(glm::max(tx0, tx1), glm::max(ty0, ty1)), glm::min(glm::max(tz0, tz1), closestHits[i]));
+			hits |= RayMask(tEnter <= tExit) << i;
+		}
+		return hits & mask;
+	}
+};
+
+struct BVHNode
+{
+	AABB Bounds;
+	uint32_t LeftFirst = 0; // Index of the left child for interior nodes (right is LeftFirst + 1), first primitive for leaves
+	uint32_t Count = 0;     // Number of primitives in a leaf, 0 for interior nodes
+
+	bool IsLeaf() const { return Count > 0; }
+};
+
+struct BVHStats
+{
+	uint32_t PrimitiveCount = 0;
+	uint32_t NodeCount = 0;
+	uint32_t LeafCount = 0;
+	uint32_t MaxDepth = 0;
+	uint32_t MaxLeafSize = 0;
+	float AverageLeafSize = 0.0f;
+	float SAHCost = 0.0f;
+	float BuildTimeMs = 0.0f;
+};
+
+// Bounding volume hierarchy over an arbitrary set of primitives, built with the binned surface area heuristic.
+// The primitives themselves are not stored, leaves reference them through GetPrimitiveIndices().
+class BVH
+{
+public:
+	static constexpr uint32_t MaxDepth = 64;
+
+	// batchWidth is the number of primitives the caller intersects at once (its SIMD width). Leaves are costed
+	// per batch, so the builder prefers filling a batch over splitting further.
+	void Build(const std::vector<AABB>& primitiveBounds, uint32_t maxLeafSize = 4, uint32_t batchWidth = 1);
+	// Takes over a tree built earlier, such as one loaded from a scene file, instead of building one. The nodes
+	// must form a valid tree over primitiveIndices.
+	void Assign(std::vector<BVHNode> nodes, std::vector<uint32_t> primitiveIndices, uint32_t maxLeafSize, uint32_t batchWidth);
+	// Updates the tree after the bounds of changedPrimitives changed, keeping its topology: only the leaves holding
+	// them and the nodes above are re-bounded, so the cost grows with the number of changes and the depth of the
+	// tree rather than its size. The SAH cost in GetStats() is kept current, callers compare it with
+	// GetBuildSAHCost() to rebuild once moved primitives have left the tree too loose.
+	void Refit(const std::vector<AABB>& primitiveBounds, const std::vector<uint32_t>& changedPrimitives);
+
+	// Walks the tree front-to-back and calls intersectPrimitive(primitiveIndex, closestHit) for every primitive in
+	// a visited leaf. The callback is expected to lower closestHit when it finds a nearer hit, which prunes the
+	// remaining nodes.
+	template<typename IntersectFn>
+	void Traverse(const Ray& ray, float& closestHit, IntersectFn&& intersectPrimitive) const
+	{
+		TraverseLeaves(ray, closestHit,
+			[&](const BVHNode& leaf, float& closest)
+			{
+				for (uint32_t i = 0; i < leaf.Count; i++)
+					intersectPrimitive(m_PrimitiveIndices[leaf.LeftFirst + i], closest);
+			});
+	}
+
+	// Same walk as Traverse, but hands every visited leaf to the callback as a whole. Used by callers that store
+	// their primitives in BVH order, where a leaf is simply the range [LeftFirst, LeftFirst + Count).
+	template<typename IntersectFn>
+	void TraverseLeaves(const Ray& ray, float& closestHit, IntersectFn&& intersectLeaf) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		glm::vec3 invDirection = 1.0f / ray.Direction;
+		if (m_Nodes[0].Bounds.Intersect(ray, invDirection, closestHit) == FLT_MAX)
+			return;
+
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		uint32_t nodeVisits = 0;
+
+		while (true)
+		{
+			nodeVisits++;
+			const BVHNode& node = m_Nodes[nodeIndex];
+			if (node.IsLeaf())
+			{
+				intersectLeaf(node, closestHit);
+			}
+			else
+			{
+				uint32_t nearChild = node.LeftFirst;
+				uint32_t farChild = node.LeftFirst + 1;
+				float nearDistance = m_Nodes[nearChild].Bounds.Intersect(ray, invDirection, closestHit);
+				float farDistance = m_Nodes[farChild].Bounds.Intersect(ray, invDirection, closestHit);
+				if (farDistance < nearDistance)
+				{
+					std::swap(nearChild, farChild);
+					std::swap(nearDistance, farDistance);
+				}
+
+				if (nearDistance != FLT_MAX)
+				{
+					if (farDistance != FLT_MAX)
+						stack[stackSize++] = farChild;
+					nodeIndex = nearChild;
+					continue;
+				}
+			}
+
+			// Pop the next node that is still closer than the current hit
+			bool found = false;
+			while (stackSize > 0)
+			{
+				nodeIndex = stack[--stackSize];
+				if (m_Nodes[nodeIndex].Bounds.Intersect(ray, invDirection, closestHit) != FLT_MAX)
+				{
+					found = true;
+					break;
+				}
+			}
+			if (!found)
+			{
+				RT_STAT_ADD(NodeVisits, nodeVisits);
+				return;
+			}
+		}
+	}
+
+	// Any-hit walk for occlusion queries. Visits the leaves whose bounds the ray enters before maxDistance, in no
+	// particular order, and stops as soon as intersectLeaf(leaf) returns true. Returns whether it stopped early.
+	template<typename IntersectFn>
+	bool TraverseAny(const Ray& ray, float maxDistance, IntersectFn&& intersectLeaf) const
+	{
+		if (m_Nodes.empty())
+			return false;
+
+		glm::vec3 invDirection = 1.0f / ray.Direction;
+
+		// Both children are pushed, so the stack holds at most one more entry than the tree is deep
+		uint32_t stack[MaxDepth + 1];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		uint32_t nodeVisits = 0;
+		bool hit = false;
+
+		while (stackSize > 0)
+		{
+			const BVHNode& node = m_Nodes[stack[--stackSize]];
+			nodeVisits++;
+			if (node.Bounds.Intersect(ray, invDirection, maxDistance) == FLT_MAX)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				if (intersectLeaf(node))
+				{
+					hit = true;
+					break;
+				}
+			}
+			else
+			{
+				stack[stackSize++] = node.LeftFirst + 1;
+				stack[stackSize++] = node.LeftFirst;
+			}
+		}
+
+		RT_STAT_ADD(NodeVisits, nodeVisits);
+		return hit;
+	}
+
+	// Packet version of TraverseLeaves. Nodes are visited once for the whole packet and intersectLeaf(leaf, mask)
+	// receives the rays that reached the leaf. closestHits holds one distance per ray, updated by the callback.
+	template<typename IntersectFn>
+	void TraversePacket(const RayPacket& packet, RayMask activeMask, const float* closestHits, IntersectFn&& intersectLeaf) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		RayMask mask = m_Nodes[0].Bounds.Intersect(packet, closestHits, activeMask);
+		if (!mask)
+			return;
+
+		struct StackEntry
+		{
+			uint32_t Node;
+			RayMask Mask;
+		};
+		StackEntry stack[MaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t nodeIndex = 0;
+		uint32_t nodeVisits = 0;
+
+		while (true)
+		{
+			nodeVisits++;
+			const BVHNode& node = m_Nodes[nodeIndex];
+			if (node.IsLeaf())
+			{
+				intersectLeaf(node, mask);
+			}
+			else
+			{
+				// All rays share the origin, so the child closer to it is the one most rays reach first
+				uint32_t nearChild = node.LeftFirst;
+				uint32_t farChild = node.LeftFirst + 1;
+				glm::vec3 toNear = m_Nodes[nearChild].Bounds.Centroid() - packet.Origin;
+				glm::vec3 toFar = m_Nodes[farChild].Bounds.Centroid() - packet.Origin;
+				if (glm::dot(toFar, toFar) < glm::dot(toNear, toNear))
+					std::swap(nearChild, farChild);
+
+				RayMask nearMask = m_Nodes[nearChild].Bounds.Intersect(packet, closestHits, mask);
+				RayMask farMask = m_Nodes[farChild].Bounds.Intersect(packet, closestHits, mask);
+				if (nearMask)
+				{
+					if (farMask)
+						stack[stackSize++] = { farChild, farMask };
+					nodeIndex = nearChild;
+					mask = nearMask;
+					continue;
+				}
+				if (farMask)
+				{
+					nodeIndex = farChild;
+					mask = farMask;
+					continue;
+				}
+			}
+
+			// Pop the next node, dropping rays that have since found a closer hit
+			bool found = false;
+			while (stackSize > 0)
+			{
+				const StackEntry& entry = stack[--stackSize];
+				mask = m_Nodes[entry.Node].Bounds.Intersect(packet, closestHits, entry.Mask);
+				if (mask)
+				{
+					nodeIndex = entry.Node;
+					found = true;
+					break;
+				}
+			}
+			if (!found)
+			{
+				RT_STAT_ADD(NodeVisits, nodeVisits);
+				return;
+			}
+		}
+	}
+
+	const std::vector<BVHNode>& GetNodes() const { return m_Nodes; }
+	const std::vector<uint32_t>& GetPrimitiveIndices() const { return m_PrimitiveIndices; }
+	const BVHStats& GetStats() const { return m_Stats; }
+	float GetBuildSAHCost() const { return m_BuildSAHCost; }
+	uint32_t GetMaxLeafSize() const { return m_MaxLeafSize; }
+	uint32_t GetBatchWidth() const { return m_BatchWidth; }
+	AABB GetBounds() const { return m_Nodes.empty() ? AABB{} : m_Nodes[0].Bounds; }
+	bool IsEmpty() const { return m_Nodes.empty(); }
+private:
+	void Subdivide(uint32_t nodeIndex, uint32_t depth, const std::vector<AABB>& primitiveBounds, const std::vector<glm::vec3>& centroids);
+	bool FindSplit(const BVHNode& node, const std::vector<AABB>& primitiveBounds, const std::vector<glm::vec3>& centroids, int& axis, float& splitPosition, float& cost) const;
+	void UpdateNodeBounds(BVHNode& node, const std::vector<AABB>& primitiveBounds) const;
+	void CalculateStats();
+	uint32_t BatchCount(uint32_t primitiveCount) const { return (primitiveCount + m_BatchWidth - 1) / m_BatchWidth; }
+	// SAH cost of one node before dividing by the root area
+	float GetNodeCost(const BVHNode& node) const;
+private:
+	std::vector<BVHNode> m_Nodes;
+	std::vector<uint32_t> m_PrimitiveIndices;
+	uint32_t m_MaxLeafSize = 4;
+	uint32_t m_BatchWidth = 1;
+	BVHStats m_Stats;
+	float m_BuildSAHCost = 0.0f;
+	double m_CostSum = 0.0; // Sum of GetNodeCost over all nodes
+
+	// Built by the first Refit, most trees are never refitted
+	std::vector<uint32_t> m_Parents;        // Parent of every node, the root's is itself
+	std::vector<uint32_t> m_PrimitiveLeaves; // Leaf holding every primitive
+};
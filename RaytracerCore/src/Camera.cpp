@@ -0,0 +1,180 @@
+#include "Camera.h"
+#include "Profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+Camera::Camera(float verticalFOV, float nearClip, float farClip)
+	: m_VerticalFOV(verticalFOV), m_NearClip(nearClip), m_FarClip(farClip)
+{
+	m_ForwardDirection = glm::vec3(0, 0, -1);
+	m_Position = glm::vec3(0, 0, 6);
+}
+
+bool Camera::OnUpdate(float ts, const CameraInput& input)
+{
+	RT_PROFILE_SCOPE("Camera::OnUpdate");
+	glm::vec2 mousePos = input.MousePosition;
+	glm::vec2 delta = (mousePos - m_LastMousePosition) * 0.002f;
+	m_LastMousePosition = mousePos;
+
+	if (!input.Look)
+		return false;
+
+	bool moved = false;
+
+	constexpr glm::vec3 upDirection(0.0f, 1.0f, 0.0f);
+	glm::vec3 rightDirection = glm::cross(m_ForwardDirection, upDirection);
+
+	float speed = 5.0f;
+
+	// Movement
+	if (input.Forward)
+	{
+		m_Position += m_ForwardDirection * speed * ts;
+		moved = true;
+	}
+	else if (input.Backward)
+	{
+		m_Position -= m_ForwardDirection * speed * ts;
+		moved = true;
+	}
+	if (input.Left)
+	{
+		m_Position -= rightDirection * speed * ts;
+		moved = true;
+	}
+	else if (input.Right)
+	{
+		m_Position += rightDirection * speed * ts;
+		moved = true;
+	}
+	if (input.Down)
+	{
+		m_Position -= upDirection * speed * ts;
+		moved = true;
+	}
+	else if (input.Up)
+	{
+		m_Position += upDirection * speed * ts;
+		moved = true;
+	}
+
+	// Rotation
+	if (delta.x != 0.0f || delta.y != 0.0f)
+	{
+		float pitchDelta = delta.y * GetRotationSpeed();
+		float yawDelta = delta.x * GetRotationSpeed();
+
+		glm::quat q = glm::normalize(glm::cross(glm::angleAxis(-pitchDelta, rightDirection),
+			glm::angleAxis(-yawDelta, glm::vec3(0.f, 1.0f, 0.0f))));
+		m_ForwardDirection = glm::rotate(q, m_ForwardDirection);
+
+		moved = true;
+	}
+
+	if (moved)
+	{
+		RecalculateView();
+		RecalculateRayBasis();
+	}
+
+	return moved;
+}
+
+void Camera::OnResize(uint32_t width, uint32_t height)
+{
+	if (width == m_ViewportWidth && height == m_ViewportHeight)
+		return;
+
+	m_ViewportWidth = width;
+	m_ViewportHeight = height;
+
+	RecalculateProjection();
+	RecalculateRayBasis();
+}
+
+void Camera::updateView()
+{
+	RecalculateProjection();
+	RecalculateRayBasis();
+}
+
+void Camera::SetView(const glm::vec3& position, const glm::vec3& forwardDirection)
+{
+	m_Position = position;
+	m_ForwardDirection = glm::normalize(forwardDirection);
+
+	RecalculateView();
+	RecalculateRayBasis();
+}
+
+float Camera::GetRotationSpeed()
+{
+	return 0.3f;
+}
+
+void Camera::RecalculateProjection()
+{
+	m_Projection = glm::perspectiveFov(glm::radians(m_VerticalFOV), (float)m_ViewportWidth, (float)m_ViewportHeight, m_NearClip, m_FarClip);
+	m_InverseProjection = glm::inverse(m_Projection);
+}
+
+void Camera::RecalculateView()
+{
+	m_View = glm::lookAt(m_Position, m_Position + m_ForwardDirection, glm::vec3(0, 1, 0));
+	m_InverseView = glm::inverse(m_View);
+}
+
+void Camera::RecalculateRayBasis()
+{
+	if (m_ViewportWidth == 0 || m_ViewportHeight == 0)
+		return;
+
+	// Same frustum as the projection and view matrices: the image plane at distance 1 spans tan(fov / 2) up and
+	// down and aspect times that sideways
+	const float halfHeight = glm::tan(glm::radians(m_VerticalFOV) * 0.5f);
+	const float halfWidth = halfHeight * (float)m_ViewportWidth / (float)m_ViewportHeight;
+
+	const glm::vec3 forward = glm::normalize(m_ForwardDirection);
+	m_RightDirection = glm::normalize(glm::cross(forward, glm::vec3(0, 1, 0)));
+	m_UpDirection = glm::cross(m_RightDirection, forward);
+
+	m_RayCorner = forward - halfWidth * m_RightDirection - halfHeight * m_UpDirection;
+	m_RayDeltaX = m_RightDirection * (2.0f * halfWidth / (float)m_ViewportWidth);
+	m_RayDeltaY = m_UpDirection * (2.0f * halfHeight / (float)m_ViewportHeight);
+}
+
+Ray Camera::GenerateRay(float x, float y, const glm::vec2& lensSample) const
+{
+	glm::vec3 direction = m_RayCorner + x * m_RayDeltaX + y * m_RayDeltaY;
+	if (m_Aperture <= 0.0f)
+		return Ray{ m_Position, glm::normalize(direction) };
+
+	// Thin lens: every ray through the lens meets the pinhole ray on the plane of focus. The lens sample is
+	// mapped to the disk with the concentric mapping, which keeps stratified samples stratified.
+	glm::vec2 offset = lensSample * 2.0f - 1.0f;
+	glm::vec2 disk(0.0f);
+	if (offset.x != 0.0f || offset.y != 0.0f)
+	{
+		constexpr float quarterPi = 0.78539816f;
+		float radius, theta;
+		if (glm::abs(offset.x) > glm::abs(offset.y))
+		{
+			radius = offset.x;
+			theta = quarterPi * (offset.y / offset.x);
+		}
+		else
+		{
+			radius = offset.y;
+			theta = 2.0f * quarterPi - quarterPi * (offset.x / offset.y);
+		}
+		disk = radius * glm::vec2(glm::cos(theta), glm::sin(theta));
+	}
+
+	// direction has unit length along the forward axis, so scaling it by the focus distance lands on the plane
+	glm::vec3 focusPoint = m_Position + direction * m_FocusDistance;
+	glm::vec3 origin = m_Position + (disk.x * m_RightDirection + disk.y * m_UpDirection) * (m_Aperture * 0.5f);
+	return Ray{ origin, glm::normalize(focusPoint - origin) };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+#include "Ray.h"
+
+// Input state for one frame, filled in by the app so the camera doesn't depend on a windowing library
+struct CameraInput
+{
+	glm::vec2 MousePosition{ 0.0f };
+	bool Look = false; // Right mouse button, movement and mouse look only apply while it is held
+	bool Forward = false, Backward = false;
+	bool Left = false, Right = false;
+	bool Down = false, Up = false;
+};
+
+class Camera
+{
+public:
+	Camera(float verticalFOV, float nearClip, float farClip);
+
+	bool OnUpdate(float ts, const CameraInput& input);
+	void OnResize(uint32_t width, uint32_t height);
+	void updateView();
+	void SetView(const glm::vec3& position, const glm::vec3& forwardDirection);
+
+	const glm::mat4& GetProjection() const { return m_Projection; }
+	const glm::mat4& GetInverseProjection() const { return m_InverseProjection; }
+	const glm::mat4& GetView() const { return m_View; }
+	const glm::mat4& GetInverseView() const { return m_InverseView; }
+	
+	const glm::vec3& GetPosition() const { return m_Position; }
+	const glm::vec3& GetDirection() const { return m_ForwardDirection; }
+
+	// Primary ray through the continuous pixel position (x, y), pixel (0, 0) spans [0, 1)^2 at the bottom left.
+	// lensSample in [0, 1)^2 picks the point on the lens when the aperture is open, 0.5 is its centre.
+	Ray GenerateRay(float x, float y, const glm::vec2& lensSample = glm::vec2(0.5f)) const;
+	bool HasDepthOfField() const { return m_Aperture > 0.0f; }
+
+	float GetRotationSpeed();
+
+	float* getFOV() { return &m_VerticalFOV; }
+	float* getNearClip() { return &m_NearClip; }
+	float* getFarClip() { return &m_FarClip; }
+	// Lens diameter in world units, 0 is a pinhole camera
+	float* getAperture() { return &m_Aperture; }
+	float* getFocusDistance() { return &m_FocusDistance; }
+private:
+	void RecalculateProjection();
+	void RecalculateView();
+	void RecalculateRayBasis();
+private:
+	glm::mat4 m_Projection{ 1.0f };
+	glm::mat4 m_View{ 1.0f };
+	glm::mat4 m_InverseProjection{ 1.0f };
+	glm::mat4 m_InverseView{ 1.0f };
+
+	float m_VerticalFOV = 45.0f;
+	float m_NearClip = 0.1f;
+	float m_FarClip = 100.0f;
+	float m_Aperture = 0.0f;
+	float m_FocusDistance = 6.0f;
+
+	glm::vec3 m_Position{0.0f, 0.0f, 0.0f};
+	glm::vec3 m_ForwardDirection{0.0f, 0.0f, 0.0f};
+
+	// Unnormalized direction through the bottom left corner of the image and its change per pixel, so a
+	// primary ray is two multiply-adds and a normalize
+	glm::vec3 m_RayCorner{ 0.0f };
+	glm::vec3 m_RayDeltaX{ 0.0f }, m_RayDeltaY{ 0.0f };
+	glm::vec3 m_RightDirection{ 1.0f, 0.0f, 0.0f }, m_UpDirection{ 0.0f, 1.0f, 0.0f };
+
+	glm::vec2 m_LastMousePosition{ 0.0f, 0.0f };
+
+	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
+};
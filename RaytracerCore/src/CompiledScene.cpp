@@ -0,0 +1,428 @@
+#include "CompiledScene.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Utils {
+	// Light a sphere of this material emits, the way the renderer shades every emissive surface
+	static glm::vec3 GetEmitterRadiance(const Material& material)
+	{
+		return material.getEmission() * material.Albedo;
+	}
+
+	static float GetLuminance(const glm::vec3& color)
+	{
+		return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+	}
+
+	static MeshInstance CreateMeshInstance(const Model& model)
+	{
+		const AffineTransform objectToWorld = model.GetObjectToWorld();
+		MeshInstance instance;
+		instance.Geometry = &model.GetGeometry();
+		instance.WorldToObject = objectToWorld.Inverse();
+		instance.NormalToWorld = glm::transpose(instance.WorldToObject.Linear);
+		instance.MaterialIndex = (uint32_t)model.MaterialIndex;
+		return instance;
+	}
+
+	// The packet's rays in the space of an instance. Directions are not renormalized so hit distances stay
+	// comparable with the other objects'.
+	static void TransformPacket(const RayPacket& packet, const AffineTransform& transform, RayPacket& localPacket)
+	{
+		localPacket.Origin = transform.TransformPoint(packet.Origin);
+		localPacket.Size = 0;
+		for (uint32_t i = 0; i < packet.Size; i++)
+			localPacket.Push(transform.TransformDirection(glm::vec3(packet.DirectionX[i], packet.DirectionY[i], packet.DirectionZ[i])));
+	}
+}
+
+void CompiledScene::Build(const Scene& scene)
+{
+	m_Spheres.Clear();
+	m_Planes.Clear();
+	m_MeshInstances.clear();
+	m_LeafPrimitives.clear();
+	m_PrimitiveBounds.clear();
+	m_ObjectSlots.assign(scene.Objects.size(), ObjectSlot{});
+	m_Kernels = &GetIntersectKernels();
+
+	// Gather bounded objects first, spheres ahead of meshes so a sorted leaf lists its spheres first
+	std::vector<uint32_t> spheres;
+	std::vector<uint32_t> models;
+	for (uint32_t i = 0; i < (uint32_t)scene.Objects.size(); i++)
+	{
+		const SceneObject& obj = *scene.Objects[i];
+		switch (obj.GetType())
+		{
+		case ObjectType::Sphere:
+			spheres.push_back(i);
+			break;
+		case ObjectType::Plane:
+		{
+			const Plane& plane = static_cast<const Plane&>(obj);
+			m_ObjectSlots[i].Index = (uint32_t)m_Planes.Size();
+			m_Planes.Push(plane.Position, plane.Normal, plane.MaterialIndex);
+			break;
+		}
+		case ObjectType::Model:
+			if (obj.GetBounds().IsValid())
+				models.push_back(i);
+			break;
+		}
+	}
+
+	m_PrimitiveBounds.reserve(spheres.size() + models.size());
+	for (uint32_t sphere : spheres)
+		m_PrimitiveBounds.push_back(scene.Objects[sphere]->GetBounds());
+	for (uint32_t model : models)
+		m_PrimitiveBounds.push_back(scene.Objects[model]->GetBounds());
+
+	m_BVH.Build(m_PrimitiveBounds, 8, GetSIMDWidth(m_Kernels->Level));
+
+	// Lay the primitives out in leaf order so a leaf is a contiguous run of spheres followed by mesh instances
+	m_LeafPrimitives = m_BVH.GetPrimitiveIndices();
+	for (const BVHNode& node : m_BVH.GetNodes())
+	{
+		if (node.IsLeaf())
+			std::sort(m_LeafPrimitives.begin() + node.LeftFirst, m_LeafPrimitives.begin() + node.LeftFirst + node.Count);
+	}
+
+	const uint32_t sphereCount = (uint32_t)spheres.size();
+	for (uint32_t& primitive : m_LeafPrimitives)
+	{
+		const uint32_t bvhPrimitive = primitive;
+		if (primitive < sphereCount)
+		{
+			const uint32_t object = spheres[primitive];
+			const Sphere& sphere = static_cast<const Sphere&>(*scene.Objects[object]);
+			primitive = (uint32_t)m_Spheres.Size();
+			m_ObjectSlots[object] = { primitive, bvhPrimitive };
+			m_Spheres.Push(sphere.Position, sphere.Radius, sphere.MaterialIndex);
+		}
+		else
+		{
+			const uint32_t object = models[primitive - sphereCount];
+			const Model& model = static_cast<const Model&>(*scene.Objects[object]);
+			m_ObjectSlots[object] = { (uint32_t)m_MeshInstances.size(), bvhPrimitive };
+			primitive = (uint32_t)m_MeshInstances.size() | MeshInstanceFlag;
+			m_MeshInstances.push_back(Utils::CreateMeshInstance(model));
+		}
+	}
+
+	BuildEmitters(scene);
+
+	m_Version = scene.GetVersion();
+	m_StructureVersion = scene.GetStructureVersion();
+	m_MaterialsVersion = scene.GetMaterialsVersion();
+	m_RefitCount = 0;
+}
+
+bool CompiledScene::Update(const Scene& scene)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (m_Kernels != &GetIntersectKernels() || scene.GetStructureVersion() != m_StructureVersion || scene.Objects.size() != m_ObjectSlots.size())
+		Build(scene);
+	else if (scene.GetVersion() != m_Version)
+		Refit(scene);
+	else
+		return false;
+
+	m_UpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return true;
+}
+
+void CompiledScene::Refit(const Scene& scene)
+{
+	// Objects keep their slots, only the values copied into them and the bounds above them change
+	m_ChangedPrimitives.clear();
+	bool emittersChanged = scene.GetMaterialsVersion() != m_MaterialsVersion;
+	for (size_t i = 0; i < scene.Objects.size(); i++)
+	{
+		if (scene.GetObjectVersion(i) <= m_Version)
+			continue;
+
+		const SceneObject& obj = *scene.Objects[i];
+		const ObjectSlot slot = m_ObjectSlots[i];
+		switch (obj.GetType())
+		{
+		case ObjectType::Sphere:
+		{
+			const float radius = static_cast<const Sphere&>(obj).Radius;
+			m_Spheres.Set(slot.Index, obj.Position, radius, obj.MaterialIndex);
+
+			// A moved light keeps its selection probability, anything else changes the emitter list
+			const glm::vec3 radiance = Utils::GetEmitterRadiance(scene.materials[obj.MaterialIndex]);
+			const uint32_t emitter = m_SphereEmitters[slot.Index];
+			if (emitter != NoEmitter && m_Emitters[emitter].Radius == radius && m_Emitters[emitter].Radiance == radiance)
+				m_Emitters[emitter].Center = obj.Position;
+			else if (emitter != NoEmitter || Utils::GetLuminance(radiance) > 0.0f)
+				emittersChanged = true;
+			break;
+		}
+		case ObjectType::Plane:
+			m_Planes.Set(slot.Index, obj.Position, static_cast<const Plane&>(obj).Normal, obj.MaterialIndex);
+			break;
+		case ObjectType::Model:
+			// The geometry is shared and never changes, only the instance's transform and material are copied
+			if (slot.Index != NoSlot)
+				m_MeshInstances[slot.Index] = Utils::CreateMeshInstance(static_cast<const Model&>(obj));
+			break;
+		}
+
+		if (slot.Primitive != NoSlot)
+		{
+			m_PrimitiveBounds[slot.Primitive] = obj.GetBounds();
+			m_ChangedPrimitives.push_back(slot.Primitive);
+		}
+	}
+
+	m_BVH.Refit(m_PrimitiveBounds, m_ChangedPrimitives);
+	if (m_BVH.GetStats().SAHCost > m_BVH.GetBuildSAHCost() * MaxRefitCostGrowth)
+	{
+		Build(scene);
+		return;
+	}
+
+	if (emittersChanged)
+		BuildEmitters(scene);
+
+	m_Version = scene.GetVersion();
+	m_MaterialsVersion = scene.GetMaterialsVersion();
+	m_RefitCount++;
+}
+
+void CompiledScene::BuildEmitters(const Scene& scene)
+{
+	m_Emitters.clear();
+	m_EmitterCdf.clear();
+
+	// Emissive spheres, in sphere buffer order so hits map straight back to their emitter
+	float totalPower = 0.0f;
+	m_SphereEmitters.assign(m_Spheres.Size(), NoEmitter);
+	for (uint32_t i = 0; i < (uint32_t)m_Spheres.Size(); i++)
+	{
+		const glm::vec3 radiance = Utils::GetEmitterRadiance(scene.materials[m_Spheres.MaterialIndex[i]]);
+		const float luminance = Utils::GetLuminance(radiance);
+		if (luminance <= 0.0f || m_Spheres.Radius[i] <= 0.0f)
+			continue;
+
+		Emitter emitter;
+		emitter.Center = m_Spheres.GetCenter(i);
+		emitter.Radius = m_Spheres.Radius[i];
+		emitter.Radiance = radiance;
+		// Power is proportional to radiance times surface area
+		emitter.SelectionPdf = luminance * emitter.Radius * emitter.Radius;
+		totalPower += emitter.SelectionPdf;
+
+		m_SphereEmitters[i] = (uint32_t)m_Emitters.size();
+		m_Emitters.push_back(emitter);
+	}
+
+	float cdf = 0.0f;
+	for (Emitter& emitter : m_Emitters)
+	{
+		emitter.SelectionPdf /= totalPower;
+		cdf += emitter.SelectionPdf;
+		m_EmitterCdf.push_back(cdf);
+	}
+}
+
+bool CompiledScene::Intersect(const Ray& ray, HitRecord& hit) const
+{
+	hit.Distance = FLT_MAX;
+	uint32_t primitiveTests = (uint32_t)m_Planes.Size();
+
+	uint32_t plane = m_Kernels->Planes(ray, m_Planes, 0, (uint32_t)m_Planes.Size(), hit.Distance);
+	if (plane != IntersectKernels::NoHit)
+	{
+		hit.Type = ObjectType::Plane;
+		hit.PrimitiveIndex = plane;
+	}
+
+	m_BVH.TraverseLeaves(ray, hit.Distance,
+		[&](const BVHNode& leaf, float& closest)
+		{
+			// Spheres come first in a leaf and occupy a contiguous range of the sphere buffer
+			uint32_t end = leaf.LeftFirst + leaf.Count;
+			uint32_t i = leaf.LeftFirst;
+			while (i < end && !(m_LeafPrimitives[i] & MeshInstanceFlag))
+				i++;
+
+			if (i > leaf.LeftFirst)
+			{
+				uint32_t sphere = m_Kernels->Spheres(ray, m_Spheres, m_LeafPrimitives[leaf.LeftFirst], i - leaf.LeftFirst, closest);
+				if (sphere != IntersectKernels::NoHit)
+				{
+					hit.Type = ObjectType::Sphere;
+					hit.PrimitiveIndex = sphere;
+				}
+				primitiveTests += i - leaf.LeftFirst;
+			}
+
+			for (; i < end; i++)
+			{
+				uint32_t instance = m_LeafPrimitives[i] & ~MeshInstanceFlag;
+				const MeshInstance& meshInstance = m_MeshInstances[instance];
+				uint32_t triangle = 0;
+				float meshClosest = closest;
+				meshInstance.Geometry->Intersect(meshInstance.WorldToObject.TransformRay(ray), meshClosest, triangle);
+				if (meshClosest < closest)
+				{
+					closest = meshClosest;
+					hit.Type = ObjectType::Model;
+					hit.PrimitiveIndex = instance;
+					hit.TriangleIndex = triangle;
+				}
+			}
+		});
+
+	RT_STAT_ADD(PrimitiveTests, primitiveTests);
+	return hit.Distance != FLT_MAX;
+}
+
+void CompiledScene::IntersectPacket(const RayPacket& packet, HitRecord* hits) const
+{
+	float closest[RayPacket::MaxSize];
+	uint32_t primitiveTests = packet.Size * (uint32_t)m_Planes.Size();
+	for (uint32_t i = 0; i < packet.Size; i++)
+	{
+		closest[i] = FLT_MAX;
+		uint32_t plane = m_Kernels->Planes(packet.GetRay(i), m_Planes, 0, (uint32_t)m_Planes.Size(), closest[i]);
+		if (plane != IntersectKernels::NoHit)
+		{
+			hits[i].Type = ObjectType::Plane;
+			hits[i].PrimitiveIndex = plane;
+		}
+	}
+
+	RayPacket localPacket;
+	m_BVH.TraversePacket(packet, packet.GetFullMask(), closest,
+		[&](const BVHNode& leaf, RayMask mask)
+		{
+			uint32_t end = leaf.LeftFirst + leaf.Count;
+			uint32_t i = leaf.LeftFirst;
+			while (i < end && !(m_LeafPrimitives[i] & MeshInstanceFlag))
+				i++;
+
+			if (i > leaf.LeftFirst)
+			{
+				uint32_t firstSphere = m_LeafPrimitives[leaf.LeftFirst];
+				uint32_t sphereCount = i - leaf.LeftFirst;
+				ForEachActiveRay(mask, [&](uint32_t ray)
+					{
+						uint32_t sphere = m_Kernels->Spheres(packet.GetRay(ray), m_Spheres, firstSphere, sphereCount, closest[ray]);
+						if (sphere != IntersectKernels::NoHit)
+						{
+							hits[ray].Type = ObjectType::Sphere;
+							hits[ray].PrimitiveIndex = sphere;
+						}
+						primitiveTests += sphereCount;
+					});
+			}
+
+			for (; i < end; i++)
+			{
+				uint32_t instance = m_LeafPrimitives[i] & ~MeshInstanceFlag;
+				const MeshInstance& meshInstance = m_MeshInstances[instance];
+				Utils::TransformPacket(packet, meshInstance.WorldToObject, localPacket);
+				uint32_t triangles[RayPacket::MaxSize];
+				RayMask hitMask = meshInstance.Geometry->IntersectPacket(localPacket, mask, closest, triangles);
+				ForEachActiveRay(hitMask, [&](uint32_t ray)
+					{
+						hits[ray].Type = ObjectType::Model;
+						hits[ray].PrimitiveIndex = instance;
+						hits[ray].TriangleIndex = triangles[ray];
+					});
+			}
+		});
+
+	for (uint32_t i = 0; i < packet.Size; i++)
+		hits[i].Distance = closest[i];
+	RT_STAT_ADD(PrimitiveTests, primitiveTests);
+}
+
+bool CompiledScene::IsOccluded(const Ray& ray, float maxDistance) const
+{
+	uint32_t primitiveTests = (uint32_t)m_Planes.Size();
+	float closest = maxDistance;
+	bool occluded = m_Kernels->Planes(ray, m_Planes, 0, (uint32_t)m_Planes.Size(), closest) != IntersectKernels::NoHit;
+
+	if (!occluded)
+	{
+		occluded = m_BVH.TraverseAny(ray, maxDistance,
+			[&](const BVHNode& leaf)
+			{
+				uint32_t end = leaf.LeftFirst + leaf.Count;
+				uint32_t i = leaf.LeftFirst;
+				while (i < end && !(m_LeafPrimitives[i] & MeshInstanceFlag))
+					i++;
+
+				if (i > leaf.LeftFirst)
+				{
+					float sphereClosest = maxDistance;
+					primitiveTests += i - leaf.LeftFirst;
+					if (m_Kernels->Spheres(ray, m_Spheres, m_LeafPrimitives[leaf.LeftFirst], i - leaf.LeftFirst, sphereClosest) != IntersectKernels::NoHit)
+						return true;
+				}
+
+				for (; i < end; i++)
+				{
+					const MeshInstance& meshInstance = m_MeshInstances[m_LeafPrimitives[i] & ~MeshInstanceFlag];
+					if (meshInstance.Geometry->IsOccluded(meshInstance.WorldToObject.TransformRay(ray), maxDistance))
+						return true;
+				}
+				return false;
+			});
+	}
+
+	RT_STAT_ADD(PrimitiveTests, primitiveTests);
+	return occluded;
+}
+
+glm::vec3 CompiledScene::GetNormal(const Ray& ray, const HitRecord& hit) const
+{
+	switch (hit.Type)
+	{
+	case ObjectType::Sphere:
+		return glm::normalize(ray.Origin + ray.Direction * hit.Distance - m_Spheres.GetCenter(hit.PrimitiveIndex));
+	case ObjectType::Plane:
+		return m_Planes.GetNormal(hit.PrimitiveIndex);
+	case ObjectType::Model:
+	{
+		// Geometric normal facing against the ray so both sides of the triangle shade alike
+		const MeshInstance& instance = m_MeshInstances[hit.PrimitiveIndex];
+		const glm::vec3 normal = glm::normalize(instance.NormalToWorld * instance.Geometry->GetNormal(hit.TriangleIndex));
+		return glm::dot(normal, ray.Direction) > 0.0f ? -normal : normal;
+	}
+	}
+	return glm::vec3(0.0f);
+}
+
+uint32_t CompiledScene::GetMaterialIndex(const HitRecord& hit) const
+{
+	switch (hit.Type)
+	{
+	case ObjectType::Sphere:
+		return m_Spheres.MaterialIndex[hit.PrimitiveIndex];
+	case ObjectType::Plane:
+		return m_Planes.MaterialIndex[hit.PrimitiveIndex];
+	case ObjectType::Model:
+		return m_MeshInstances[hit.PrimitiveIndex].MaterialIndex;
+	}
+	return 0;
+}
+
+uint32_t CompiledScene::PickEmitter(float u) const
+{
+	// The last entry may round to just below 1, so clamp instead of trusting the search to stop in range
+	size_t index = std::upper_bound(m_EmitterCdf.begin(), m_EmitterCdf.end(), u) - m_EmitterCdf.begin();
+	return (uint32_t)std::min(index, m_Emitters.size() - 1);
+}
+
+uint32_t CompiledScene::GetEmitterIndex(const HitRecord& hit) const
+{
+	return hit.Type == ObjectType::Sphere ? m_SphereEmitters[hit.PrimitiveIndex] : NoEmitter;
+}
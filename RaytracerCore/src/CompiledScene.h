@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <cfloat>
+
+#include "BVH.h"
+#include "Primitives.h"
+#include "Scene.h"
+#include "IntersectKernels.h"
+
+struct HitRecord
+{
+	float Distance = FLT_MAX;
+	ObjectType Type = ObjectType::Sphere;
+	uint32_t PrimitiveIndex = 0; // Index into the sphere/plane buffer or the mesh instance list
+	uint32_t TriangleIndex = 0;  // Triangle within the mesh, only meaningful for ObjectType::Model
+};
+
+// A model as the renderer traces it: rays are moved into the space of its shared geometry rather than the
+// geometry into the scene, so any number of instances cost one copy of the triangles and BVH
+struct MeshInstance
+{
+	const MeshGeometry* Geometry = nullptr;
+	AffineTransform WorldToObject;
+	glm::mat3 NormalToWorld{ 1.0f }; // Inverse transpose of the object to world map
+	uint32_t MaterialIndex = 0;
+};
+
+// Emissive sphere for direct light sampling. Spheres are the only shape with a closed-form solid angle to sample,
+// emissive planes and meshes are still found by bounces alone.
+struct Emitter
+{
+	glm::vec3 Center{ 0.0f };
+	float Radius = 0.0f;
+	glm::vec3 Radiance{ 0.0f }; // Emission times albedo, the way the renderer shades every emissive surface
+	float SelectionPdf = 0.0f;  // Emitters are picked in proportion to their power
+};
+
+// Flat, type segregated copy of a Scene that the renderer traces against. Spheres and planes are copied into
+// structure-of-arrays buffers, models become instances referencing their shared, already flattened geometry.
+// A top level BVH is built over spheres and mesh instances; planes are unbounded and tested against every ray.
+class CompiledScene
+{
+public:
+	void Build(const Scene& scene);
+	// Brings the copy up to date with the edits made through the scene's change tracking since the last Build or
+	// Update. Edited objects are updated in place and the top level BVH is refitted around them; objects being
+	// added or removed, a change of intersection kernels or a refit that loosened the tree too much fall back to
+	// Build. Returns whether anything changed.
+	bool Update(const Scene& scene);
+
+	bool Intersect(const Ray& ray, HitRecord& hit) const;
+	// Closest hit for every ray of the packet, misses are left with Distance == FLT_MAX
+	void IntersectPacket(const RayPacket& packet, HitRecord* hits) const;
+	// Any-hit query for shadow rays: true if anything is hit closer than maxDistance. Stops at the first hit
+	// instead of searching for the closest one.
+	bool IsOccluded(const Ray& ray, float maxDistance) const;
+	glm::vec3 GetNormal(const Ray& ray, const HitRecord& hit) const;
+	uint32_t GetMaterialIndex(const HitRecord& hit) const;
+
+	static constexpr uint32_t NoEmitter = UINT32_MAX;
+	const std::vector<Emitter>& GetEmitters() const { return m_Emitters; }
+	// Emitter for a uniform random number u, with probability Emitter::SelectionPdf. The scene must have emitters.
+	uint32_t PickEmitter(float u) const;
+	// Index into GetEmitters() of the emitter that was hit, or NoEmitter
+	uint32_t GetEmitterIndex(const HitRecord& hit) const;
+
+	const SphereBuffer& GetSpheres() const { return m_Spheres; }
+	const PlaneBuffer& GetPlanes() const { return m_Planes; }
+	const std::vector<MeshInstance>& GetMeshInstances() const { return m_MeshInstances; }
+	const BVHStats& GetStats() const { return m_BVH.GetStats(); }
+	// Time the last Update that changed anything took, and the refits done since the last full build
+	float GetUpdateMs() const { return m_UpdateMs; }
+	uint32_t GetRefitCount() const { return m_RefitCount; }
+private:
+	void Refit(const Scene& scene);
+	void BuildEmitters(const Scene& scene);
+private:
+	// Top level leaf entries are either a sphere index or a mesh instance index tagged with this bit
+	static constexpr uint32_t MeshInstanceFlag = 0x80000000u;
+	// Refits keep the topology, so the tree gets looser as objects move away from where it was built. It is
+	// rebuilt once its SAH cost has grown by this factor.
+	static constexpr float MaxRefitCostGrowth = 1.5f;
+	static constexpr uint32_t NoSlot = UINT32_MAX;
+
+	// Where a scene object was compiled to: its index in the sphere or plane buffer or the mesh instance list and
+	// its primitive in the top level BVH, NoSlot for planes and empty models
+	struct ObjectSlot
+	{
+		uint32_t Index = NoSlot;
+		uint32_t Primitive = NoSlot;
+	};
+
+	SphereBuffer m_Spheres;
+	PlaneBuffer m_Planes;
+	std::vector<MeshInstance> m_MeshInstances;
+
+	std::vector<Emitter> m_Emitters;
+	std::vector<float> m_EmitterCdf;        // Running sum of the selection pdfs
+	std::vector<uint32_t> m_SphereEmitters; // Emitter of every sphere in the sphere buffer, or NoEmitter
+
+	BVH m_BVH;
+	std::vector<uint32_t> m_LeafPrimitives;
+	std::vector<AABB> m_PrimitiveBounds; // By top level primitive, kept for refits
+	std::vector<ObjectSlot> m_ObjectSlots; // By scene object
+	std::vector<uint32_t> m_ChangedPrimitives;
+
+	// Scene versions this copy is up to date with
+	uint64_t m_Version = 0;
+	uint64_t m_StructureVersion = 0;
+	uint64_t m_MaterialsVersion = 0;
+	float m_UpdateMs = 0.0f;
+	uint32_t m_RefitCount = 0;
+
+	const IntersectKernels* m_Kernels = nullptr;
+};
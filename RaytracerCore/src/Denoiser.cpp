@@ -0,0 +1,360 @@
+#include "Denoiser.h"
+#include "IntersectKernels.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// Depth of the row padding, far enough from anything the renderer produces that its weight is negligible
+	constexpr float PaddingDepth = 1e30f;
+	// Weights are floored at e^-MaxExponent. Going lower only produces denormals once they are multiplied with the
+	// kernel and colour, which are very slow on x64 and change nothing visible.
+	constexpr float MaxExponent = 60.0f;
+	constexpr uint32_t DenoiseTileSize = 64;
+
+	// 1D B-spline kernel, the 5x5 kernel is its outer product
+	constexpr float KernelWeights[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+	// Everything one filter iteration needs, planes are indexed with the padded stride
+	struct FilterPass
+	{
+		const float* Source[3];
+		float* Destination[3];
+		const float* Normal[3];
+		const float* Depth;
+		uint32_t Height;
+		size_t Stride;
+		uint32_t Padding;
+		int32_t Step;
+		float InvColorSigma2;
+		float InvNormalSigma2;
+		float DepthSigma; // Per pixel of tap distance, multiplied by Step and the centre depth
+	};
+
+	void FilterPixelScalar(const FilterPass& pass, uint32_t x, uint32_t y)
+	{
+		const size_t p = (size_t)y * pass.Stride + x + pass.Padding;
+		const float cr = pass.Source[0][p], cg = pass.Source[1][p], cb = pass.Source[2][p];
+		const float nx = pass.Normal[0][p], ny = pass.Normal[1][p], nz = pass.Normal[2][p];
+		const float depth = pass.Depth[p];
+		const float depthScale = pass.DepthSigma * (float)pass.Step * std::max(depth, 1e-3f);
+		const float invDepthSigma2 = 1.0f / (depthScale * depthScale);
+
+		float sumR = 0.0f, sumG = 0.0f, sumB = 0.0f, weightSum = 0.0f;
+		for (int32_t ky = -2; ky <= 2; ky++)
+		{
+			const int32_t qy = (int32_t)y + ky * pass.Step;
+			if (qy < 0 || qy >= (int32_t)pass.Height)
+				continue;
+
+			for (int32_t kx = -2; kx <= 2; kx++)
+			{
+				const size_t q = (size_t)qy * pass.Stride + (size_t)((int32_t)x + kx * pass.Step + (int32_t)pass.Padding);
+				const float dr = pass.Source[0][q] - cr, dg = pass.Source[1][q] - cg, db = pass.Source[2][q] - cb;
+				const float dnx = pass.Normal[0][q] - nx, dny = pass.Normal[1][q] - ny, dnz = pass.Normal[2][q] - nz;
+				const float dz = pass.Depth[q] - depth;
+
+				float exponent = (dr * dr + dg * dg + db * db) * pass.InvColorSigma2
+					+ (dnx * dnx + dny * dny + dnz * dnz) * pass.InvNormalSigma2
+					+ dz * dz * invDepthSigma2;
+				float weight = KernelWeights[ky + 2] * KernelWeights[kx + 2] * std::exp(-std::min(exponent, MaxExponent));
+
+				sumR += pass.Source[0][q] * weight;
+				sumG += pass.Source[1][q] * weight;
+				sumB += pass.Source[2][q] * weight;
+				weightSum += weight;
+			}
+		}
+
+		// The centre tap always has a weight, so weightSum is never zero
+		pass.Destination[0][p] = sumR / weightSum;
+		pass.Destination[1][p] = sumG / weightSum;
+		pass.Destination[2][p] = sumB / weightSum;
+	}
+
+	void FilterRowScalar(const FilterPass& pass, uint32_t y, uint32_t minX, uint32_t maxX)
+	{
+		for (uint32_t x = minX; x < maxX; x++)
+			FilterPixelScalar(pass, x, y);
+	}
+
+#if RT_SIMD_X64
+	// SSE, 4 pixels of a row per iteration
+
+	// e^x for x <= 0 as 2^(x log2 e), splitting off the integer part into the exponent bits and approximating
+	// the fraction with a polynomial. Relative error is around 1e-7, inputs below -MaxExponent are clamped.
+	inline __m128 ExpSSE(__m128 x)
+	{
+		x = _mm_max_ps(x, _mm_set1_ps(-MaxExponent));
+		__m128 t = _mm_mul_ps(x, _mm_set1_ps(1.44269504f));
+
+		// Floor, truncation rounds towards zero which is one too high for negative fractions
+		__m128i truncated = _mm_cvttps_epi32(t);
+		__m128 truncatedFloat = _mm_cvtepi32_ps(truncated);
+		__m128 adjust = _mm_and_ps(_mm_cmplt_ps(t, truncatedFloat), _mm_set1_ps(1.0f));
+		__m128 floored = _mm_sub_ps(truncatedFloat, adjust);
+		__m128 f = _mm_sub_ps(t, floored);
+
+		__m128 p = _mm_set1_ps(1.33335581e-3f);
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(9.61812911e-3f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(5.55041087e-2f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.40226507e-1f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(6.93147182e-1f));
+		p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+
+		__m128i exponent = _mm_slli_epi32(_mm_cvttps_epi32(floored), 23);
+		return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(p), exponent));
+	}
+
+	void FilterRowSSE(const FilterPass& pass, uint32_t y, uint32_t minX, uint32_t maxX)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 invColorSigma2 = _mm_set1_ps(pass.InvColorSigma2);
+		const __m128 invNormalSigma2 = _mm_set1_ps(pass.InvNormalSigma2);
+		const __m128 depthSigma = _mm_set1_ps(pass.DepthSigma * (float)pass.Step);
+
+		uint32_t x = minX;
+		for (; x + 4 <= maxX; x += 4)
+		{
+			const size_t p = (size_t)y * pass.Stride + x + pass.Padding;
+			const __m128 cr = _mm_loadu_ps(pass.Source[0] + p), cg = _mm_loadu_ps(pass.Source[1] + p), cb = _mm_loadu_ps(pass.Source[2] + p);
+			const __m128 nx = _mm_loadu_ps(pass.Normal[0] + p), ny = _mm_loadu_ps(pass.Normal[1] + p), nz = _mm_loadu_ps(pass.Normal[2] + p);
+			const __m128 depth = _mm_loadu_ps(pass.Depth + p);
+			const __m128 depthScale = _mm_mul_ps(depthSigma, _mm_max_ps(depth, _mm_set1_ps(1e-3f)));
+			const __m128 invDepthSigma2 = _mm_div_ps(one, _mm_mul_ps(depthScale, depthScale));
+
+			__m128 sumR = _mm_setzero_ps(), sumG = _mm_setzero_ps(), sumB = _mm_setzero_ps(), weightSum = _mm_setzero_ps();
+			for (int32_t ky = -2; ky <= 2; ky++)
+			{
+				const int32_t qy = (int32_t)y + ky * pass.Step;
+				if (qy < 0 || qy >= (int32_t)pass.Height)
+					continue;
+
+				for (int32_t kx = -2; kx <= 2; kx++)
+				{
+					const size_t q = (size_t)qy * pass.Stride + (size_t)((int32_t)x + kx * pass.Step + (int32_t)pass.Padding);
+					const __m128 qr = _mm_loadu_ps(pass.Source[0] + q), qg = _mm_loadu_ps(pass.Source[1] + q), qb = _mm_loadu_ps(pass.Source[2] + q);
+					const __m128 dr = _mm_sub_ps(qr, cr), dg = _mm_sub_ps(qg, cg), db = _mm_sub_ps(qb, cb);
+					const __m128 dnx = _mm_sub_ps(_mm_loadu_ps(pass.Normal[0] + q), nx);
+					const __m128 dny = _mm_sub_ps(_mm_loadu_ps(pass.Normal[1] + q), ny);
+					const __m128 dnz = _mm_sub_ps(_mm_loadu_ps(pass.Normal[2] + q), nz);
+					const __m128 dz = _mm_sub_ps(_mm_loadu_ps(pass.Depth + q), depth);
+
+					__m128 colorDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+					__m128 normalDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dnx, dnx), _mm_mul_ps(dny, dny)), _mm_mul_ps(dnz, dnz));
+					__m128 exponent = _mm_add_ps(_mm_mul_ps(colorDistance, invColorSigma2), _mm_mul_ps(normalDistance, invNormalSigma2));
+					exponent = _mm_add_ps(exponent, _mm_mul_ps(_mm_mul_ps(dz, dz), invDepthSigma2));
+
+					__m128 weight = _mm_mul_ps(_mm_set1_ps(KernelWeights[ky + 2] * KernelWeights[kx + 2]), ExpSSE(_mm_sub_ps(_mm_setzero_ps(), exponent)));
+					sumR = _mm_add_ps(sumR, _mm_mul_ps(qr, weight));
+					sumG = _mm_add_ps(sumG, _mm_mul_ps(qg, weight));
+					sumB = _mm_add_ps(sumB, _mm_mul_ps(qb, weight));
+					weightSum = _mm_add_ps(weightSum, weight);
+				}
+			}
+
+			const __m128 invWeightSum = _mm_div_ps(one, weightSum);
+			_mm_storeu_ps(pass.Destination[0] + p, _mm_mul_ps(sumR, invWeightSum));
+			_mm_storeu_ps(pass.Destination[1] + p, _mm_mul_ps(sumG, invWeightSum));
+			_mm_storeu_ps(pass.Destination[2] + p, _mm_mul_ps(sumB, invWeightSum));
+		}
+
+		FilterRowScalar(pass, y, x, maxX);
+	}
+
+	// AVX2 + FMA, 8 pixels of a row per iteration
+
+	RT_TARGET_AVX2 inline __m256 ExpAVX2(__m256 x)
+	{
+		x = _mm256_max_ps(x, _mm256_set1_ps(-MaxExponent));
+		__m256 t = _mm256_mul_ps(x, _mm256_set1_ps(1.44269504f));
+		__m256 floored = _mm256_floor_ps(t);
+		__m256 f = _mm256_sub_ps(t, floored);
+
+		__m256 p = _mm256_set1_ps(1.33335581e-3f);
+		p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(9.61812911e-3f));
+		p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(5.55041087e-2f));
+		p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(2.40226507e-1f));
+		p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(6.93147182e-1f));
+		p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+
+		__m256i exponent = _mm256_slli_epi32(_mm256_cvttps_epi32(floored), 23);
+		return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(p), exponent));
+	}
+
+	RT_TARGET_AVX2 void FilterRowAVX2(const FilterPass& pass, uint32_t y, uint32_t minX, uint32_t maxX)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 invColorSigma2 = _mm256_set1_ps(pass.InvColorSigma2);
+		const __m256 invNormalSigma2 = _mm256_set1_ps(pass.InvNormalSigma2);
+		const __m256 depthSigma = _mm256_set1_ps(pass.DepthSigma * (float)pass.Step);
+
+		uint32_t x = minX;
+		for (; x + 8 <= maxX; x += 8)
+		{
+			const size_t p = (size_t)y * pass.Stride + x + pass.Padding;
+			const __m256 cr = _mm256_loadu_ps(pass.Source[0] + p), cg = _mm256_loadu_ps(pass.Source[1] + p), cb = _mm256_loadu_ps(pass.Source[2] + p);
+			const __m256 nx = _mm256_loadu_ps(pass.Normal[0] + p), ny = _mm256_loadu_ps(pass.Normal[1] + p), nz = _mm256_loadu_ps(pass.Normal[2] + p);
+			const __m256 depth = _mm256_loadu_ps(pass.Depth + p);
+			const __m256 depthScale = _mm256_mul_ps(depthSigma, _mm256_max_ps(depth, _mm256_set1_ps(1e-3f)));
+			const __m256 invDepthSigma2 = _mm256_div_ps(one, _mm256_mul_ps(depthScale, depthScale));
+
+			__m256 sumR = _mm256_setzero_ps(), sumG = _mm256_setzero_ps(), sumB = _mm256_setzero_ps(), weightSum = _mm256_setzero_ps();
+			for (int32_t ky = -2; ky <= 2; ky++)
+			{
+				const int32_t qy = (int32_t)y + ky * pass.Step;
+				if (qy < 0 || qy >= (int32_t)pass.Height)
+					continue;
+
+				for (int32_t kx = -2; kx <= 2; kx++)
+				{
+					const size_t q = (size_t)qy * pass.Stride + (size_t)((int32_t)x + kx * pass.Step + (int32_t)pass.Padding);
+					const __m256 qr = _mm256_loadu_ps(pass.Source[0] + q), qg = _mm256_loadu_ps(pass.Source[1] + q), qb = _mm256_loadu_ps(pass.Source[2] + q);
+					const __m256 dr = _mm256_sub_ps(qr, cr), dg = _mm256_sub_ps(qg, cg), db = _mm256_sub_ps(qb, cb);
+					const __m256 dnx = _mm256_sub_ps(_mm256_loadu_ps(pass.Normal[0] + q), nx);
+					const __m256 dny = _mm256_sub_ps(_mm256_loadu_ps(pass.Normal[1] + q), ny);
+					const __m256 dnz = _mm256_sub_ps(_mm256_loadu_ps(pass.Normal[2] + q), nz);
+					const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(pass.Depth + q), depth);
+
+					__m256 colorDistance = _mm256_fmadd_ps(dr, dr, _mm256_fmadd_ps(dg, dg, _mm256_mul_ps(db, db)));
+					__m256 normalDistance = _mm256_fmadd_ps(dnx, dnx, _mm256_fmadd_ps(dny, dny, _mm256_mul_ps(dnz, dnz)));
+					__m256 exponent = _mm256_fmadd_ps(colorDistance, invColorSigma2, _mm256_mul_ps(normalDistance, invNormalSigma2));
+					exponent = _mm256_fmadd_ps(_mm256_mul_ps(dz, dz), invDepthSigma2, exponent);
+
+					__m256 weight = _mm256_mul_ps(_mm256_set1_ps(KernelWeights[ky + 2] * KernelWeights[kx + 2]), ExpAVX2(_mm256_sub_ps(_mm256_setzero_ps(), exponent)));
+					sumR = _mm256_fmadd_ps(qr, weight, sumR);
+					sumG = _mm256_fmadd_ps(qg, weight, sumG);
+					sumB = _mm256_fmadd_ps(qb, weight, sumB);
+					weightSum = _mm256_add_ps(weightSum, weight);
+				}
+			}
+
+			const __m256 invWeightSum = _mm256_div_ps(one, weightSum);
+			_mm256_storeu_ps(pass.Destination[0] + p, _mm256_mul_ps(sumR, invWeightSum));
+			_mm256_storeu_ps(pass.Destination[1] + p, _mm256_mul_ps(sumG, invWeightSum));
+			_mm256_storeu_ps(pass.Destination[2] + p, _mm256_mul_ps(sumB, invWeightSum));
+		}
+
+		FilterRowScalar(pass, y, x, maxX);
+	}
+#endif
+
+	using FilterRowFn = void(*)(const FilterPass& pass, uint32_t y, uint32_t minX, uint32_t maxX);
+
+	FilterRowFn GetFilterRow(SIMDLevel level)
+	{
+#if RT_SIMD_X64
+		if (level == SIMDLevel::AVX2)
+			return FilterRowAVX2;
+		if (level == SIMDLevel::SSE)
+			return FilterRowSSE;
+#endif
+		return FilterRowScalar;
+	}
+}
+
+void Denoiser::Resize(uint32_t width, uint32_t height)
+{
+	if (width == m_Width && height == m_Height)
+		return;
+
+	m_Width = width;
+	m_Height = height;
+	m_Stride = width + 2 * Padding;
+
+	// Only the interior is ever written, so the padding keeps the values set here
+	const size_t size = (size_t)m_Stride * height;
+	for (auto& planes : m_Color)
+		for (std::vector<float>& plane : planes)
+			plane.assign(size, 0.0f);
+	for (std::vector<float>& plane : m_Albedo)
+		plane.assign(size, 0.0f);
+	for (std::vector<float>& plane : m_Normal)
+		plane.assign(size, 0.0f);
+	m_Depth.assign(size, PaddingDepth);
+}
+
+void Denoiser::Denoise(const DenoiserInput& input, glm::vec3* output, TileScheduler& scheduler)
+{
+	Resize(input.Width, input.Height);
+	if (m_Width == 0 || m_Height == 0)
+		return;
+
+	// Average the sums into the padded planes and take the albedo out of the colour
+	scheduler.Run(m_Width, m_Height, DenoiseTileSize,
+		[&](const Tile& tile, uint32_t)
+		{
+			for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+				{
+					const size_t pixel = x + (size_t)y * m_Width;
+					const size_t index = GetIndex(x, y);
+					const float invSamples = 1.0f / (float)std::max(input.SampleCounts[pixel], 1u);
+
+					const glm::vec3 color = glm::vec3(input.Color[pixel]) * invSamples;
+					const glm::vec3 albedo = input.Albedo[pixel] * invSamples;
+					const glm::vec3 normal = input.Normal[pixel] * invSamples;
+					for (int c = 0; c < 3; c++)
+					{
+						// Black albedo (misses, pure emitters) can't be divided out, those pixels are filtered as is
+						const float demodulate = albedo[c] > 1e-3f ? albedo[c] : 1.0f;
+						m_Color[0][c][index] = color[c] / demodulate;
+						m_Albedo[c][index] = demodulate;
+						m_Normal[c][index] = normal[c];
+					}
+					m_Depth[index] = input.Depth[pixel] * invSamples;
+				}
+			}
+		});
+
+	const FilterRowFn filterRow = GetFilterRow(GetIntersectKernels().Level);
+	const uint32_t iterations = glm::clamp(m_Settings.Iterations, 1u, MaxIterations);
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		const float colorSigma = std::max(m_Settings.ColorSigma, 1e-4f) / (float)(1u << i);
+		const float normalSigma = std::max(m_Settings.NormalSigma, 1e-4f);
+
+		FilterPass pass;
+		for (int c = 0; c < 3; c++)
+		{
+			pass.Source[c] = m_Color[i % 2][c].data();
+			pass.Destination[c] = m_Color[(i + 1) % 2][c].data();
+			pass.Normal[c] = m_Normal[c].data();
+		}
+		pass.Depth = m_Depth.data();
+		pass.Height = m_Height;
+		pass.Stride = m_Stride;
+		pass.Padding = Padding;
+		pass.Step = 1 << i;
+		pass.InvColorSigma2 = 1.0f / (colorSigma * colorSigma);
+		pass.InvNormalSigma2 = 1.0f / (normalSigma * normalSigma);
+		pass.DepthSigma = std::max(m_Settings.DepthSigma, 1e-4f);
+
+		scheduler.Run(m_Width, m_Height, DenoiseTileSize,
+			[&](const Tile& tile, uint32_t)
+			{
+				for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+					filterRow(pass, y, tile.MinX, tile.MaxX);
+			});
+	}
+
+	// Put the albedo back
+	const auto& filtered = m_Color[iterations % 2];
+	scheduler.Run(m_Width, m_Height, DenoiseTileSize,
+		[&](const Tile& tile, uint32_t)
+		{
+			for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+				{
+					const size_t index = GetIndex(x, y);
+					output[x + (size_t)y * m_Width] = glm::vec3(
+						filtered[0][index] * m_Albedo[0][index],
+						filtered[1][index] * m_Albedo[1][index],
+						filtered[2][index] * m_Albedo[2][index]);
+				}
+			}
+		});
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "TileScheduler.h"
+
+// Accumulated per-pixel sums from the renderer, width x height with row 0 at the bottom. Each is divided by the
+// pixel's sample count to get the average the filter works on.
+struct DenoiserInput
+{
+	const glm::vec3* Color = nullptr;
+	const glm::vec3* Albedo = nullptr;
+	const glm::vec3* Normal = nullptr;
+	const float* Depth = nullptr;
+	const uint32_t* SampleCounts = nullptr;
+	uint32_t Width = 0, Height = 0;
+};
+
+// Edge-avoiding À-trous wavelet filter (Dammertz et al. 2010). Every iteration applies a 5x5 B-spline kernel
+// whose taps are spread twice as far apart as in the previous one, and weights each tap down where the colour,
+// normal or depth differ from the centre pixel so edges stay sharp. The colour is divided by the first-hit albedo
+// before filtering and multiplied back afterwards, so only the noisy lighting gets blurred.
+class Denoiser
+{
+public:
+	struct Settings
+	{
+		uint32_t Iterations = 5;  // Filter radius is 2^(Iterations + 1) pixels, at most 5 iterations
+		float ColorSigma = 1.0f;  // Halved every iteration, as the colour gets less noisy
+		float NormalSigma = 0.3f;
+		float DepthSigma = 0.05f; // Relative to the centre pixel's depth, per pixel of tap distance
+	};
+
+	// Filters input into output (linear RGB, width x height) using the scheduler's threads
+	void Denoise(const DenoiserInput& input, glm::vec3* output, TileScheduler& scheduler);
+
+	Settings& GetSettings() { return m_Settings; }
+private:
+	void Resize(uint32_t width, uint32_t height);
+	size_t GetIndex(uint32_t x, uint32_t y) const { return (size_t)y * m_Stride + x + Padding; }
+private:
+	// Rows are padded on both sides so the widest taps never need a bounds check, the padding has a depth no
+	// pixel can match which gives it zero weight
+	static constexpr uint32_t MaxIterations = 5;
+	static constexpr uint32_t Padding = 2u << (MaxIterations - 1);
+
+	Settings m_Settings;
+	uint32_t m_Width = 0, m_Height = 0, m_Stride = 0;
+
+	// Planar storage, the colour planes are ping-ponged between iterations
+	std::vector<float> m_Color[2][3];
+	std::vector<float> m_Albedo[3];
+	std::vector<float> m_Normal[3];
+	std::vector<float> m_Depth;
+};
@@ -0,0 +1,46 @@
+#include "Framebuffer.h"
+
+#include <cstring>
+
+namespace Utils {
+	template<typename T>
+	static void ClearRange(AlignedBuffer<T>& buffer, size_t first, size_t count)
+	{
+		// Every element is made of floats and integers, for which all bits zero is zero
+		std::memset(buffer.Data() + first, 0, count * sizeof(T));
+	}
+}
+
+bool Framebuffer::Resize(uint32_t width, uint32_t height)
+{
+	Width = width;
+	Height = height;
+
+	const size_t pixelCount = (size_t)width * height;
+	bool reallocated = Color.Resize(pixelCount);
+	reallocated |= SampleCount.Resize(pixelCount);
+	reallocated |= Variance.Resize(pixelCount);
+	reallocated |= Albedo.Resize(pixelCount);
+	reallocated |= Normal.Resize(pixelCount);
+	reallocated |= Depth.Resize(pixelCount);
+	return reallocated;
+}
+
+void Framebuffer::Clear(TileScheduler& scheduler, uint32_t tileSize)
+{
+	scheduler.Run(Width, Height, tileSize,
+		[this](const Tile& tile, uint32_t)
+		{
+			const size_t count = tile.MaxX - tile.MinX;
+			for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				const size_t row = tile.MinX + (size_t)y * Width;
+				Utils::ClearRange(Color, row, count);
+				Utils::ClearRange(SampleCount, row, count);
+				Utils::ClearRange(Variance, row, count);
+				Utils::ClearRange(Albedo, row, count);
+				Utils::ClearRange(Normal, row, count);
+				Utils::ClearRange(Depth, row, count);
+			}
+		});
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "TileScheduler.h"
+
+// Array starting on a cache line, for per-pixel data that many threads write. The capacity only grows, by at
+// least half again each time, so shrinking or growing back within it keeps the allocation and dragging the
+// viewport size stops allocating after the first few frames. Contents are left uninitialized.
+template<typename T>
+class AlignedBuffer
+{
+	static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer never constructs or destroys its elements");
+public:
+	static constexpr size_t Alignment = 64;
+
+	AlignedBuffer() = default;
+	~AlignedBuffer() { Free(); }
+
+	AlignedBuffer(const AlignedBuffer&) = delete;
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+	AlignedBuffer(AlignedBuffer&& other) noexcept { Swap(other); }
+	AlignedBuffer& operator=(AlignedBuffer&& other) noexcept { Swap(other); return *this; }
+
+	// Returns true if the storage was reallocated, which loses the contents
+	bool Resize(size_t size)
+	{
+		m_Size = size;
+		if (size <= m_Capacity)
+			return false;
+
+		const size_t capacity = std::max(size, m_Capacity + m_Capacity / 2);
+		Free();
+		m_Data = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t(Alignment)));
+		m_Capacity = capacity;
+		return true;
+	}
+
+	T* Data() { return m_Data; }
+	const T* Data() const { return m_Data; }
+	size_t Size() const { return m_Size; }
+	size_t Capacity() const { return m_Capacity; }
+
+	T& operator[](size_t i) { return m_Data[i]; }
+	const T& operator[](size_t i) const { return m_Data[i]; }
+private:
+	void Free()
+	{
+		if (m_Data)
+			::operator delete(m_Data, std::align_val_t(Alignment));
+		m_Data = nullptr;
+		m_Capacity = 0;
+	}
+
+	void Swap(AlignedBuffer& other)
+	{
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_Capacity, other.m_Capacity);
+	}
+private:
+	T* m_Data = nullptr;
+	size_t m_Size = 0, m_Capacity = 0;
+};
+
+// Per-pixel sums the renderer accumulates its samples into, Width x Height with row 0 at the bottom. Each is
+// divided by the pixel's sample count for its average. Colour is summed as RGB, an alpha channel would only
+// ever count the samples again and cost a quarter of the bandwidth.
+struct Framebuffer
+{
+	AlignedBuffer<glm::vec3> Color;
+	AlignedBuffer<uint32_t> SampleCount;
+	AlignedBuffer<glm::vec2> Variance; // Sum and sum of squares of the clamped luminance of every sample
+	AlignedBuffer<glm::vec3> Albedo;
+	AlignedBuffer<glm::vec3> Normal;
+	AlignedBuffer<float> Depth;
+	uint32_t Width = 0, Height = 0;
+
+	// Contents are undefined afterwards. Returns true if any buffer had to be reallocated.
+	bool Resize(uint32_t width, uint32_t height);
+	// Zeroes every buffer, tile by tile on the scheduler's threads. After a reallocation this is the first touch
+	// of the pages, so on NUMA machines they are placed on the node of a thread that renders those tiles.
+	void Clear(TileScheduler& scheduler, uint32_t tileSize);
+};
@@ -0,0 +1,182 @@
+#include "ImageIO.h"
+#include "Tonemapper.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+
+namespace Utils {
+	// All formats below store binary values little endian
+	static void WriteU32(std::ofstream& file, uint32_t value)
+	{
+		char bytes[4] = { (char)(value), (char)(value >> 8), (char)(value >> 16), (char)(value >> 24) };
+		file.write(bytes, 4);
+	}
+
+	static void WriteU64(std::ofstream& file, uint64_t value)
+	{
+		WriteU32(file, (uint32_t)value);
+		WriteU32(file, (uint32_t)(value >> 32));
+	}
+
+	static void WriteF32(std::ofstream& file, float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		WriteU32(file, bits);
+	}
+
+	static void WriteString(std::ofstream& file, const char* string)
+	{
+		file.write(string, std::strlen(string) + 1);
+	}
+
+	static void WriteAttribute(std::ofstream& file, const char* name, const char* type, uint32_t size)
+	{
+		WriteString(file, name);
+		WriteString(file, type);
+		WriteU32(file, size);
+	}
+
+	static std::string GetExtension(const std::string& path)
+	{
+		size_t dot = path.find_last_of('.');
+		if (dot == std::string::npos)
+			return "";
+
+		std::string extension = path.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+		return extension;
+	}
+}
+
+bool WritePFM(const std::string& path, const float* rgb, uint32_t width, uint32_t height)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	// A negative scale marks little endian data, rows go bottom to top which matches the renderer
+	file << "PF\n" << width << " " << height << "\n-1.0\n";
+	for (size_t i = 0; i < (size_t)width * height * 3; i++)
+		Utils::WriteF32(file, rgb[i]);
+
+	return (bool)file;
+}
+
+bool WritePPM(const std::string& path, const float* rgb, uint32_t width, uint32_t height, const Tonemapper* tonemapper)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	// The default settings are the plain clamp
+	const Tonemapper clamp;
+	if (!tonemapper)
+		tonemapper = &clamp;
+
+	std::vector<uint32_t> pixels(width);
+	std::vector<uint8_t> row(width * 3);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		// PPM rows go top to bottom
+		const float* source = rgb + (size_t)(height - 1 - y) * width * 3;
+		tonemapper->Resolve((const glm::vec3*)source, pixels.data(), width);
+		for (uint32_t x = 0; x < width; x++)
+		{
+			row[x * 3 + 0] = (uint8_t)pixels[x];
+			row[x * 3 + 1] = (uint8_t)(pixels[x] >> 8);
+			row[x * 3 + 2] = (uint8_t)(pixels[x] >> 16);
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+
+	return (bool)file;
+}
+
+bool WriteEXR(const std::string& path, const float* rgb, uint32_t width, uint32_t height)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	// Magic number and version 2, single part scanline image
+	Utils::WriteU32(file, 20000630);
+	Utils::WriteU32(file, 2);
+
+	// Channels must be listed alphabetically, each entry is its name, pixel type 2 (float), pLinear, three
+	// reserved bytes and the x/y sampling rates
+	const char* channels[] = { "B", "G", "R" };
+	Utils::WriteAttribute(file, "channels", "chlist", 3 * 18 + 1);
+	for (const char* channel : channels)
+	{
+		Utils::WriteString(file, channel);
+		Utils::WriteU32(file, 2);
+		Utils::WriteU32(file, 0);
+		Utils::WriteU32(file, 1);
+		Utils::WriteU32(file, 1);
+	}
+	file.put(0);
+
+	Utils::WriteAttribute(file, "compression", "compression", 1);
+	file.put(0);
+
+	for (const char* window : { "dataWindow", "displayWindow" })
+	{
+		Utils::WriteAttribute(file, window, "box2i", 16);
+		Utils::WriteU32(file, 0);
+		Utils::WriteU32(file, 0);
+		Utils::WriteU32(file, width - 1);
+		Utils::WriteU32(file, height - 1);
+	}
+
+	Utils::WriteAttribute(file, "lineOrder", "lineOrder", 1);
+	file.put(0);
+
+	Utils::WriteAttribute(file, "pixelAspectRatio", "float", 4);
+	Utils::WriteF32(file, 1.0f);
+
+	Utils::WriteAttribute(file, "screenWindowCenter", "v2f", 8);
+	Utils::WriteF32(file, 0.0f);
+	Utils::WriteF32(file, 0.0f);
+
+	Utils::WriteAttribute(file, "screenWindowWidth", "float", 4);
+	Utils::WriteF32(file, 1.0f);
+
+	file.put(0);
+
+	// One uncompressed scanline per chunk, the offset table points at each of them
+	const uint32_t lineSize = width * 3 * sizeof(float);
+	const uint64_t firstChunk = (uint64_t)file.tellp() + (uint64_t)height * sizeof(uint64_t);
+	for (uint32_t y = 0; y < height; y++)
+		Utils::WriteU64(file, firstChunk + (uint64_t)y * (8 + lineSize));
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		// EXR rows go top to bottom, channels are stored planar per scanline in B, G, R order
+		const float* source = rgb + (size_t)(height - 1 - y) * width * 3;
+		Utils::WriteU32(file, y);
+		Utils::WriteU32(file, lineSize);
+		for (int channel = 2; channel >= 0; channel--)
+			for (uint32_t x = 0; x < width; x++)
+				Utils::WriteF32(file, source[x * 3 + channel]);
+	}
+
+	return (bool)file;
+}
+
+bool WriteImage(const std::string& path, const float* rgb, uint32_t width, uint32_t height, const Tonemapper* tonemapper)
+{
+	std::string extension = Utils::GetExtension(path);
+	if (extension == "pfm")
+		return WritePFM(path, rgb, width, height);
+	if (extension == "ppm")
+		return WritePPM(path, rgb, width, height, tonemapper);
+	if (extension == "exr")
+		return WriteEXR(path, rgb, width, height);
+	return false;
+}
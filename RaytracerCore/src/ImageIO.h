@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Tonemapper;
+
+// Writers for linear RGB float images, three floats per pixel with row 0 at the bottom as the renderer produces
+// them. Every function returns false when the file can't be written.
+
+// Portable float map, keeps the full linear range
+bool WritePFM(const std::string& path, const float* rgb, uint32_t width, uint32_t height);
+// 8 bit binary PPM, resolved through the tonemapper like the viewport. Without one the values are clamped to [0, 1].
+bool WritePPM(const std::string& path, const float* rgb, uint32_t width, uint32_t height, const Tonemapper* tonemapper = nullptr);
+// Uncompressed 32 bit float OpenEXR
+bool WriteEXR(const std::string& path, const float* rgb, uint32_t width, uint32_t height);
+
+// Picks the format from the file extension (.pfm, .ppm or .exr). The tonemapper only applies to 8 bit formats, the
+// float ones keep the linear values.
+bool WriteImage(const std::string& path, const float* rgb, uint32_t width, uint32_t height, const Tonemapper* tonemapper = nullptr);
@@ -0,0 +1,432 @@
+#include "IntersectKernels.h"
+
+#include <algorithm>
+
+namespace {
+	constexpr uint32_t NoHit = IntersectKernels::NoHit;
+
+	uint32_t ReduceClosest(const float* t, const int32_t* index, uint32_t width, float& closest)
+	{
+		uint32_t hit = NoHit;
+		for (uint32_t lane = 0; lane < width; lane++)
+		{
+			if (index[lane] >= 0 && t[lane] < closest)
+			{
+				closest = t[lane];
+				hit = (uint32_t)index[lane];
+			}
+		}
+		return hit;
+	}
+
+	// Scalar fallback
+
+	uint32_t IntersectSpheresScalar(const Ray& ray, const SphereBuffer& spheres, uint32_t first, uint32_t count, float& closest)
+	{
+		uint32_t hit = NoHit;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			float t = IntersectSphere(ray, spheres.GetCenter(i), spheres.Radius[i]);
+			if (t > 0.0f && t < closest)
+			{
+				closest = t;
+				hit = i;
+			}
+		}
+		return hit;
+	}
+
+	uint32_t IntersectPlanesScalar(const Ray& ray, const PlaneBuffer& planes, uint32_t first, uint32_t count, float& closest)
+	{
+		uint32_t hit = NoHit;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			float t = IntersectPlane(ray, planes.GetPoint(i), planes.GetNormal(i));
+			if (t > 0.0f && t < closest)
+			{
+				closest = t;
+				hit = i;
+			}
+		}
+		return hit;
+	}
+
+	uint32_t IntersectTrianglesScalar(const Ray& ray, const TriangleBuffer& triangles, uint32_t first, uint32_t count, float& closest)
+	{
+		uint32_t hit = NoHit;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			float t = IntersectTriangle(ray, triangles, i);
+			if (t > 0.0f && t < closest)
+			{
+				closest = t;
+				hit = i;
+			}
+		}
+		return hit;
+	}
+
+#if RT_SIMD_X64
+	// SSE, 4 primitives per iteration
+
+	inline __m128 LoadSSE(const float* data, uint32_t n)
+	{
+		if (n == 4)
+			return _mm_loadu_ps(data);
+
+		alignas(16) float lanes[4] = {};
+		for (uint32_t i = 0; i < n; i++)
+			lanes[i] = data[i];
+		return _mm_load_ps(lanes);
+	}
+
+	inline __m128 LaneMaskSSE(uint32_t n)
+	{
+		return _mm_castsi128_ps(_mm_cmplt_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)n)));
+	}
+
+	inline __m128 SelectSSE(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	inline __m128i SelectSSE(__m128 mask, __m128i a, __m128i b)
+	{
+		return _mm_castps_si128(SelectSSE(mask, _mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+	}
+
+	inline __m128 AbsSSE(__m128 x)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+	}
+
+	inline __m128 DotSSE(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+	}
+
+	uint32_t ReduceSSE(__m128 bestT, __m128i bestIndex, float& closest)
+	{
+		alignas(16) float t[4];
+		alignas(16) int32_t index[4];
+		_mm_store_ps(t, bestT);
+		_mm_store_si128((__m128i*)index, bestIndex);
+		return ReduceClosest(t, index, 4, closest);
+	}
+
+	uint32_t IntersectSpheresSSE(const Ray& ray, const SphereBuffer& spheres, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m128 ox = _mm_set1_ps(ray.Origin.x), oy = _mm_set1_ps(ray.Origin.y), oz = _mm_set1_ps(ray.Origin.z);
+		const __m128 dx = _mm_set1_ps(ray.Direction.x), dy = _mm_set1_ps(ray.Direction.y), dz = _mm_set1_ps(ray.Direction.z);
+		const float a = glm::dot(ray.Direction, ray.Direction);
+		const __m128 fourA = _mm_set1_ps(4.0f * a), twoA = _mm_set1_ps(2.0f * a);
+		const __m128 zero = _mm_setzero_ps(), two = _mm_set1_ps(2.0f);
+
+		__m128 bestT = _mm_set1_ps(closest);
+		__m128i bestIndex = _mm_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 4)
+		{
+			uint32_t n = std::min(4u, end - i);
+			__m128 lx = _mm_sub_ps(ox, LoadSSE(spheres.CenterX.data() + i, n));
+			__m128 ly = _mm_sub_ps(oy, LoadSSE(spheres.CenterY.data() + i, n));
+			__m128 lz = _mm_sub_ps(oz, LoadSSE(spheres.CenterZ.data() + i, n));
+			__m128 r = LoadSSE(spheres.Radius.data() + i, n);
+
+			__m128 b = _mm_mul_ps(two, DotSSE(lx, ly, lz, dx, dy, dz));
+			__m128 c = _mm_sub_ps(DotSSE(lx, ly, lz, lx, ly, lz), _mm_mul_ps(r, r));
+			__m128 d = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(fourA, c));
+			__m128 t = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(d, zero))), twoA);
+
+			__m128 mask = _mm_and_ps(LaneMaskSSE(n), _mm_cmpge_ps(d, zero));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, bestT)));
+
+			__m128i index = _mm_add_epi32(_mm_set1_epi32((int)i), _mm_setr_epi32(0, 1, 2, 3));
+			bestT = SelectSSE(mask, t, bestT);
+			bestIndex = SelectSSE(mask, index, bestIndex);
+		}
+
+		return ReduceSSE(bestT, bestIndex, closest);
+	}
+
+	uint32_t IntersectPlanesSSE(const Ray& ray, const PlaneBuffer& planes, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m128 ox = _mm_set1_ps(ray.Origin.x), oy = _mm_set1_ps(ray.Origin.y), oz = _mm_set1_ps(ray.Origin.z);
+		const __m128 dx = _mm_set1_ps(ray.Direction.x), dy = _mm_set1_ps(ray.Direction.y), dz = _mm_set1_ps(ray.Direction.z);
+		const __m128 zero = _mm_setzero_ps(), epsilon = _mm_set1_ps(1e-6f);
+
+		__m128 bestT = _mm_set1_ps(closest);
+		__m128i bestIndex = _mm_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 4)
+		{
+			uint32_t n = std::min(4u, end - i);
+			__m128 nx = LoadSSE(planes.NormalX.data() + i, n);
+			__m128 ny = LoadSSE(planes.NormalY.data() + i, n);
+			__m128 nz = LoadSSE(planes.NormalZ.data() + i, n);
+			__m128 px = _mm_sub_ps(LoadSSE(planes.PointX.data() + i, n), ox);
+			__m128 py = _mm_sub_ps(LoadSSE(planes.PointY.data() + i, n), oy);
+			__m128 pz = _mm_sub_ps(LoadSSE(planes.PointZ.data() + i, n), oz);
+
+			__m128 denom = DotSSE(nx, ny, nz, dx, dy, dz);
+			__m128 t = _mm_div_ps(DotSSE(px, py, pz, nx, ny, nz), denom);
+
+			__m128 mask = _mm_and_ps(LaneMaskSSE(n), _mm_cmpge_ps(AbsSSE(denom), epsilon));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, bestT)));
+
+			__m128i index = _mm_add_epi32(_mm_set1_epi32((int)i), _mm_setr_epi32(0, 1, 2, 3));
+			bestT = SelectSSE(mask, t, bestT);
+			bestIndex = SelectSSE(mask, index, bestIndex);
+		}
+
+		return ReduceSSE(bestT, bestIndex, closest);
+	}
+
+	uint32_t IntersectTrianglesSSE(const Ray& ray, const TriangleBuffer& triangles, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m128 ox = _mm_set1_ps(ray.Origin.x), oy = _mm_set1_ps(ray.Origin.y), oz = _mm_set1_ps(ray.Origin.z);
+		const __m128 dx = _mm_set1_ps(ray.Direction.x), dy = _mm_set1_ps(ray.Direction.y), dz = _mm_set1_ps(ray.Direction.z);
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), epsilon = _mm_set1_ps(1e-6f);
+
+		__m128 bestT = _mm_set1_ps(closest);
+		__m128i bestIndex = _mm_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 4)
+		{
+			uint32_t n = std::min(4u, end - i);
+			__m128 v0x = LoadSSE(triangles.V0X.data() + i, n);
+			__m128 v0y = LoadSSE(triangles.V0Y.data() + i, n);
+			__m128 v0z = LoadSSE(triangles.V0Z.data() + i, n);
+			__m128 e1x = LoadSSE(triangles.E1X.data() + i, n);
+			__m128 e1y = LoadSSE(triangles.E1Y.data() + i, n);
+			__m128 e1z = LoadSSE(triangles.E1Z.data() + i, n);
+			__m128 e2x = LoadSSE(triangles.E2X.data() + i, n);
+			__m128 e2y = LoadSSE(triangles.E2Y.data() + i, n);
+			__m128 e2z = LoadSSE(triangles.E2Z.data() + i, n);
+
+			// h = cross(direction, e2)
+			__m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			__m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			__m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+			__m128 a = DotSSE(e1x, e1y, e1z, hx, hy, hz);
+			__m128 f = _mm_div_ps(one, a);
+
+			__m128 sx = _mm_sub_ps(ox, v0x), sy = _mm_sub_ps(oy, v0y), sz = _mm_sub_ps(oz, v0z);
+			__m128 u = _mm_mul_ps(f, DotSSE(sx, sy, sz, hx, hy, hz));
+
+			// q = cross(s, e1)
+			__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+			__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+			__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+			__m128 v = _mm_mul_ps(f, DotSSE(dx, dy, dz, qx, qy, qz));
+			__m128 t = _mm_mul_ps(f, DotSSE(e2x, e2y, e2z, qx, qy, qz));
+
+			__m128 mask = _mm_and_ps(LaneMaskSSE(n), _mm_cmpge_ps(AbsSSE(a), epsilon));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, bestT)));
+
+			__m128i index = _mm_add_epi32(_mm_set1_epi32((int)i), _mm_setr_epi32(0, 1, 2, 3));
+			bestT = SelectSSE(mask, t, bestT);
+			bestIndex = SelectSSE(mask, index, bestIndex);
+		}
+
+		return ReduceSSE(bestT, bestIndex, closest);
+	}
+
+	// AVX2 + FMA, 8 primitives per iteration
+
+	RT_TARGET_AVX2 inline __m256i LaneIndexAVX2()
+	{
+		return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	}
+
+	RT_TARGET_AVX2 inline __m256 LoadAVX2(const float* data, uint32_t n)
+	{
+		if (n == 8)
+			return _mm256_loadu_ps(data);
+		// Masked load so a partial batch at the end of a buffer never touches memory past it
+		return _mm256_maskload_ps(data, _mm256_cmpgt_epi32(_mm256_set1_epi32((int)n), LaneIndexAVX2()));
+	}
+
+	RT_TARGET_AVX2 inline __m256 LaneMaskAVX2(uint32_t n)
+	{
+		return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32((int)n), LaneIndexAVX2()));
+	}
+
+	RT_TARGET_AVX2 inline __m256 AbsAVX2(__m256 x)
+	{
+		return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+	}
+
+	RT_TARGET_AVX2 inline __m256 DotAVX2(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+	{
+		return _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(az, bz)));
+	}
+
+	RT_TARGET_AVX2 inline void SelectClosestAVX2(__m256 mask, __m256 t, uint32_t first, __m256& bestT, __m256i& bestIndex)
+	{
+		__m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)first), LaneIndexAVX2());
+		bestT = _mm256_blendv_ps(bestT, t, mask);
+		bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), mask));
+	}
+
+	RT_TARGET_AVX2 uint32_t ReduceAVX2(__m256 bestT, __m256i bestIndex, float& closest)
+	{
+		alignas(32) float t[8];
+		alignas(32) int32_t index[8];
+		_mm256_store_ps(t, bestT);
+		_mm256_store_si256((__m256i*)index, bestIndex);
+		return ReduceClosest(t, index, 8, closest);
+	}
+
+	RT_TARGET_AVX2 uint32_t IntersectSpheresAVX2(const Ray& ray, const SphereBuffer& spheres, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m256 ox = _mm256_set1_ps(ray.Origin.x), oy = _mm256_set1_ps(ray.Origin.y), oz = _mm256_set1_ps(ray.Origin.z);
+		const __m256 dx = _mm256_set1_ps(ray.Direction.x), dy = _mm256_set1_ps(ray.Direction.y), dz = _mm256_set1_ps(ray.Direction.z);
+		const float a = ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z;
+		const __m256 fourA = _mm256_set1_ps(4.0f * a), twoA = _mm256_set1_ps(2.0f * a);
+		const __m256 zero = _mm256_setzero_ps(), two = _mm256_set1_ps(2.0f);
+
+		__m256 bestT = _mm256_set1_ps(closest);
+		__m256i bestIndex = _mm256_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 8)
+		{
+			uint32_t n = std::min(8u, end - i);
+			__m256 lx = _mm256_sub_ps(ox, LoadAVX2(spheres.CenterX.data() + i, n));
+			__m256 ly = _mm256_sub_ps(oy, LoadAVX2(spheres.CenterY.data() + i, n));
+			__m256 lz = _mm256_sub_ps(oz, LoadAVX2(spheres.CenterZ.data() + i, n));
+			__m256 r = LoadAVX2(spheres.Radius.data() + i, n);
+
+			__m256 b = _mm256_mul_ps(two, DotAVX2(lx, ly, lz, dx, dy, dz));
+			__m256 c = _mm256_fmsub_ps(lx, lx, _mm256_fmsub_ps(r, r, _mm256_fmadd_ps(ly, ly, _mm256_mul_ps(lz, lz))));
+			__m256 d = _mm256_fnmadd_ps(fourA, c, _mm256_mul_ps(b, b));
+			__m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), _mm256_sqrt_ps(_mm256_max_ps(d, zero))), twoA);
+
+			__m256 mask = _mm256_and_ps(LaneMaskAVX2(n), _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GT_OQ), _mm256_cmp_ps(t, bestT, _CMP_LT_OQ)));
+			SelectClosestAVX2(mask, t, i, bestT, bestIndex);
+		}
+
+		return ReduceAVX2(bestT, bestIndex, closest);
+	}
+
+	RT_TARGET_AVX2 uint32_t IntersectPlanesAVX2(const Ray& ray, const PlaneBuffer& planes, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m256 ox = _mm256_set1_ps(ray.Origin.x), oy = _mm256_set1_ps(ray.Origin.y), oz = _mm256_set1_ps(ray.Origin.z);
+		const __m256 dx = _mm256_set1_ps(ray.Direction.x), dy = _mm256_set1_ps(ray.Direction.y), dz = _mm256_set1_ps(ray.Direction.z);
+		const __m256 zero = _mm256_setzero_ps(), epsilon = _mm256_set1_ps(1e-6f);
+
+		__m256 bestT = _mm256_set1_ps(closest);
+		__m256i bestIndex = _mm256_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 8)
+		{
+			uint32_t n = std::min(8u, end - i);
+			__m256 nx = LoadAVX2(planes.NormalX.data() + i, n);
+			__m256 ny = LoadAVX2(planes.NormalY.data() + i, n);
+			__m256 nz = LoadAVX2(planes.NormalZ.data() + i, n);
+			__m256 px = _mm256_sub_ps(LoadAVX2(planes.PointX.data() + i, n), ox);
+			__m256 py = _mm256_sub_ps(LoadAVX2(planes.PointY.data() + i, n), oy);
+			__m256 pz = _mm256_sub_ps(LoadAVX2(planes.PointZ.data() + i, n), oz);
+
+			__m256 denom = DotAVX2(nx, ny, nz, dx, dy, dz);
+			__m256 t = _mm256_div_ps(DotAVX2(px, py, pz, nx, ny, nz), denom);
+
+			__m256 mask = _mm256_and_ps(LaneMaskAVX2(n), _mm256_cmp_ps(AbsAVX2(denom), epsilon, _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GT_OQ), _mm256_cmp_ps(t, bestT, _CMP_LT_OQ)));
+			SelectClosestAVX2(mask, t, i, bestT, bestIndex);
+		}
+
+		return ReduceAVX2(bestT, bestIndex, closest);
+	}
+
+	RT_TARGET_AVX2 uint32_t IntersectTrianglesAVX2(const Ray& ray, const TriangleBuffer& triangles, uint32_t first, uint32_t count, float& closest)
+	{
+		const __m256 ox = _mm256_set1_ps(ray.Origin.x), oy = _mm256_set1_ps(ray.Origin.y), oz = _mm256_set1_ps(ray.Origin.z);
+		const __m256 dx = _mm256_set1_ps(ray.Direction.x), dy = _mm256_set1_ps(ray.Direction.y), dz = _mm256_set1_ps(ray.Direction.z);
+		const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), epsilon = _mm256_set1_ps(1e-6f);
+
+		__m256 bestT = _mm256_set1_ps(closest);
+		__m256i bestIndex = _mm256_set1_epi32(-1);
+
+		const uint32_t end = first + count;
+		for (uint32_t i = first; i < end; i += 8)
+		{
+			uint32_t n = std::min(8u, end - i);
+			__m256 v0x = LoadAVX2(triangles.V0X.data() + i, n);
+			__m256 v0y = LoadAVX2(triangles.V0Y.data() + i, n);
+			__m256 v0z = LoadAVX2(triangles.V0Z.data() + i, n);
+			__m256 e1x = LoadAVX2(triangles.E1X.data() + i, n);
+			__m256 e1y = LoadAVX2(triangles.E1Y.data() + i, n);
+			__m256 e1z = LoadAVX2(triangles.E1Z.data() + i, n);
+			__m256 e2x = LoadAVX2(triangles.E2X.data() + i, n);
+			__m256 e2y = LoadAVX2(triangles.E2Y.data() + i, n);
+			__m256 e2z = LoadAVX2(triangles.E2Z.data() + i, n);
+
+			// h = cross(direction, e2)
+			__m256 hx = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+			__m256 hy = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+			__m256 hz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+			__m256 a = DotAVX2(e1x, e1y, e1z, hx, hy, hz);
+			__m256 f = _mm256_div_ps(one, a);
+
+			__m256 sx = _mm256_sub_ps(ox, v0x), sy = _mm256_sub_ps(oy, v0y), sz = _mm256_sub_ps(oz, v0z);
+			__m256 u = _mm256_mul_ps(f, DotAVX2(sx, sy, sz, hx, hy, hz));
+
+			// q = cross(s, e1)
+			__m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+			__m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+			__m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+			__m256 v = _mm256_mul_ps(f, DotAVX2(dx, dy, dz, qx, qy, qz));
+			__m256 t = _mm256_mul_ps(f, DotAVX2(e2x, e2y, e2z, qx, qy, qz));
+
+			__m256 mask = _mm256_and_ps(LaneMaskAVX2(n), _mm256_cmp_ps(AbsAVX2(a), epsilon, _CMP_GE_OQ));
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+			mask = _mm256_and_ps(mask, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GT_OQ), _mm256_cmp_ps(t, bestT, _CMP_LT_OQ)));
+			SelectClosestAVX2(mask, t, i, bestT, bestIndex);
+		}
+
+		return ReduceAVX2(bestT, bestIndex, closest);
+	}
+#endif
+
+	const IntersectKernels s_Kernels[] = {
+		{ IntersectSpheresScalar, IntersectPlanesScalar, IntersectTrianglesScalar, SIMDLevel::Scalar },
+#if RT_SIMD_X64
+		{ IntersectSpheresSSE, IntersectPlanesSSE, IntersectTrianglesSSE, SIMDLevel::SSE },
+		{ IntersectSpheresAVX2, IntersectPlanesAVX2, IntersectTrianglesAVX2, SIMDLevel::AVX2 },
+#endif
+	};
+
+	const IntersectKernels*& ActiveKernels()
+	{
+		static const IntersectKernels* active = &GetIntersectKernels(GetSupportedSIMDLevel());
+		return active;
+	}
+}
+
+const IntersectKernels& GetIntersectKernels()
+{
+	return *ActiveKernels();
+}
+
+const IntersectKernels& GetIntersectKernels(SIMDLevel level)
+{
+	SIMDLevel supported = GetSupportedSIMDLevel();
+	if ((int)level > (int)supported)
+		level = supported;
+	return s_Kernels[(int)level];
+}
+
+void SetIntersectKernels(SIMDLevel level)
+{
+	ActiveKernels() = &GetIntersectKernels(level);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Ray.h"
+#include "Primitives.h"
+#include "SIMD.h"
+
+// Batched intersection of one ray against a contiguous range [first, first + count) of a primitive buffer.
+// Every kernel returns the index of the closest primitive hit in front of closest and lowers closest to its
+// distance, or returns NoHit and leaves closest untouched.
+struct IntersectKernels
+{
+	static constexpr uint32_t NoHit = UINT32_MAX;
+
+	using SphereKernel = uint32_t(*)(const Ray& ray, const SphereBuffer& spheres, uint32_t first, uint32_t count, float& closest);
+	using PlaneKernel = uint32_t(*)(const Ray& ray, const PlaneBuffer& planes, uint32_t first, uint32_t count, float& closest);
+	using TriangleKernel = uint32_t(*)(const Ray& ray, const TriangleBuffer& triangles, uint32_t first, uint32_t count, float& closest);
+
+	SphereKernel Spheres;
+	PlaneKernel Planes;
+	TriangleKernel Triangles;
+	SIMDLevel Level;
+};
+
+// Kernels in use, defaults to the widest level the CPU supports
+const IntersectKernels& GetIntersectKernels();
+const IntersectKernels& GetIntersectKernels(SIMDLevel level);
+// Switches the active kernels, clamped to what the CPU supports. Not thread safe, call between frames.
+void SetIntersectKernels(SIMDLevel level);
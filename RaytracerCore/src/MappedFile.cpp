@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Size = (size_t)size.QuadPart;
+	m_Open = true;
+
+	// Empty files can't be mapped, they simply have no data
+	if (m_Size == 0)
+		return true;
+
+	m_Mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		Close();
+		return false;
+	}
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	m_Size = (size_t)info.st_size;
+	m_Open = true;
+
+	if (m_Size > 0)
+	{
+		void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			m_Size = 0;
+			m_Open = false;
+			return false;
+		}
+		madvise(data, m_Size, MADV_SEQUENTIAL);
+		m_Data = (const char*)data;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	close(file);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File)
+		CloseHandle(m_File);
+	m_Mapping = nullptr;
+	m_File = nullptr;
+#else
+	if (m_Data)
+		munmap((void*)m_Data, m_Size);
+#endif
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Open = false;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. Loaders parse straight out of the mapping instead of reading the
+// file into a buffer first, and the OS pages it in as the parser touches it.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return m_Open; }
+	const char* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+private:
+	const char* m_Data = nullptr;
+	size_t m_Size = 0;
+	bool m_Open = false;
+
+#if defined(_WIN32)
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#endif
+};
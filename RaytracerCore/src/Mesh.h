@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+#include "BVH.h"
+
+// Indexed triangle mesh. Triangles reference shared vertex positions and normals by index, so a vertex used by
+// several triangles is stored once. Models reference a mesh and build their acceleration data from it.
+struct Mesh
+{
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec3> Normals;
+	std::vector<uint32_t> Indices;       // Three positions per triangle
+	std::vector<uint32_t> NormalIndices; // Three normals per triangle, empty when the mesh has no normals
+
+	size_t GetTriangleCount() const { return Indices.size() / 3; }
+	bool HasNormals() const { return !NormalIndices.empty(); }
+
+	glm::vec3 GetVertex(size_t triangle, uint32_t corner) const { return Positions[Indices[triangle * 3 + corner]]; }
+	glm::vec3 GetNormal(size_t triangle, uint32_t corner) const { return Normals[NormalIndices[triangle * 3 + corner]]; }
+
+	// Whole triangles with every index referring to an existing position or normal. The mesh loaders always
+	// produce valid meshes, scene files are checked with this before their meshes are used.
+	bool IsValid() const
+	{
+		if (Indices.size() % 3 != 0 || (HasNormals() && NormalIndices.size() != Indices.size()))
+			return false;
+		for (uint32_t index : Indices)
+			if (index >= Positions.size())
+				return false;
+		for (uint32_t index : NormalIndices)
+			if (index >= Normals.size())
+				return false;
+		return true;
+	}
+
+	AABB GetTriangleBounds(size_t triangle) const
+	{
+		AABB bounds;
+		for (uint32_t corner = 0; corner < 3; corner++)
+			bounds.Grow(GetVertex(triangle, corner));
+		return bounds;
+	}
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <cfloat>
+
+#include "Ray.h"
+#include "RayPacket.h"
+#include "BVH.h"
+#include "Mesh.h"
+#include "Primitives.h"
+#include "IntersectKernels.h"
+#include "Stats.h"
+
+// A mesh prepared for tracing: its BVH and its triangles in leaf order, both in object space. It is built once
+// and shared by every Model instancing the mesh, which only adds a transform, so a thousand copies of an asset
+// cost a thousand transforms rather than a thousand BVHs. Rays are moved into object space to be traced.
+class MeshGeometry
+{
+public:
+	explicit MeshGeometry(std::shared_ptr<const Mesh> mesh) : m_Mesh(std::move(mesh)) { BuildBVH(); BuildTriangles(); }
+	// Uses a BVH that was built over the mesh before, such as one loaded from a scene file
+	MeshGeometry(std::shared_ptr<const Mesh> mesh, BVH bvh) : m_Mesh(std::move(mesh)), m_BVH(std::move(bvh)) { BuildTriangles(); }
+
+	// Closest-hit query for a ray in object space, lowering closestHit and recording the triangle on a nearer hit
+	void Intersect(const Ray& ray, float& closestHit, uint32_t& closestTriangle) const {
+		IntersectKernels::TriangleKernel intersectTriangles = GetIntersectKernels().Triangles;
+		uint32_t triangleTests = 0;
+		m_BVH.TraverseLeaves(ray, closestHit,
+			[&](const BVHNode& leaf, float& closest) {
+				uint32_t hit = intersectTriangles(ray, m_Triangles, leaf.LeftFirst, leaf.Count, closest);
+				if (hit != IntersectKernels::NoHit)
+					closestTriangle = hit;
+				triangleTests += leaf.Count;
+			});
+		RT_STAT_ADD(PrimitiveTests, triangleTests);
+	}
+
+	// Any-hit query for shadow rays in object space, true if some triangle is hit closer than maxDistance
+	bool IsOccluded(const Ray& ray, float maxDistance) const {
+		IntersectKernels::TriangleKernel intersectTriangles = GetIntersectKernels().Triangles;
+		uint32_t triangleTests = 0;
+		bool occluded = m_BVH.TraverseAny(ray, maxDistance,
+			[&](const BVHNode& leaf) {
+				float closest = maxDistance;
+				triangleTests += leaf.Count;
+				return intersectTriangles(ray, m_Triangles, leaf.LeftFirst, leaf.Count, closest) != IntersectKernels::NoHit;
+			});
+		RT_STAT_ADD(PrimitiveTests, triangleTests);
+		return occluded;
+	}
+
+	// Packet version of Intersect for the rays in mask. Returns the rays that found a closer hit, for which
+	// closestHits and closestTriangles have been updated.
+	RayMask IntersectPacket(const RayPacket& packet, RayMask mask, float* closestHits, uint32_t* closestTriangles) const {
+		RayMask hitMask = 0;
+		IntersectKernels::TriangleKernel intersectTriangles = GetIntersectKernels().Triangles;
+		uint32_t triangleTests = 0;
+		m_BVH.TraversePacket(packet, mask, closestHits,
+			[&](const BVHNode& leaf, RayMask leafMask) {
+				ForEachActiveRay(leafMask, [&](uint32_t i) {
+					uint32_t hit = intersectTriangles(packet.GetRay(i), m_Triangles, leaf.LeftFirst, leaf.Count, closestHits[i]);
+					if (hit != IntersectKernels::NoHit) {
+						closestTriangles[i] = hit;
+						hitMask |= RayMask(1) << i;
+					}
+					triangleTests += leaf.Count;
+				});
+			});
+		RT_STAT_ADD(PrimitiveTests, triangleTests);
+		return hitMask;
+	}
+
+	// Unit geometric normal in object space of a triangle reported by Intersect
+	glm::vec3 GetNormal(uint32_t triangle) const { return m_Triangles.GetNormal(triangle); }
+
+	AABB GetBounds() const { return m_BVH.GetBounds(); }
+	size_t GetTriangleCount() const { return m_Triangles.Size(); }
+	const BVHStats& GetBVHStats() const { return m_BVH.GetStats(); }
+	const Mesh& GetMesh() const { return *m_Mesh; }
+	const std::shared_ptr<const Mesh>& GetSharedMesh() const { return m_Mesh; }
+	const BVH& GetBVH() const { return m_BVH; }
+	// Index into the mesh of a triangle as reported by Intersect
+	uint32_t GetMeshTriangle(uint32_t triangle) const { return m_BVH.GetPrimitiveIndices()[triangle]; }
+
+private:
+	std::shared_ptr<const Mesh> m_Mesh;
+	// Preprocessed triangles in BVH leaf order, so a leaf is a contiguous range for the batched kernels
+	TriangleBuffer m_Triangles;
+	BVH m_BVH;
+
+	void BuildBVH() {
+		const size_t triangleCount = m_Mesh->GetTriangleCount();
+		std::vector<AABB> triangleBounds(triangleCount);
+		for (size_t i = 0; i < triangleCount; i++)
+			triangleBounds[i] = m_Mesh->GetTriangleBounds(i);
+		m_BVH.Build(triangleBounds, 8, GetSIMDWidth(GetIntersectKernels().Level));
+	}
+
+	void BuildTriangles() {
+		m_Triangles.Reserve(m_Mesh->GetTriangleCount());
+		for (uint32_t index : m_BVH.GetPrimitiveIndices())
+			m_Triangles.Push(m_Mesh->GetVertex(index, 0), m_Mesh->GetVertex(index, 1), m_Mesh->GetVertex(index, 2));
+	}
+};
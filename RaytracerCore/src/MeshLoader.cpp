@@ -0,0 +1,817 @@
+#include "MeshLoader.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+	// Parsing a few MB per thread keeps the thread start-up cost negligible
+	static uint32_t GetLoaderThreadCount(size_t workSize, size_t minWorkPerThread)
+	{
+		size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		return (uint32_t)std::clamp<size_t>(workSize / minWorkPerThread, 1, hardwareThreads);
+	}
+
+	// Calls fn(i) for every i in [0, count), each on its own thread
+	template<typename Fn>
+	static void ParallelFor(uint32_t count, const Fn& fn)
+	{
+		std::vector<std::thread> threads;
+		for (uint32_t i = 1; i < count; i++)
+			threads.emplace_back([&fn, i] { fn(i); });
+		if (count > 0)
+			fn(0);
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	static std::string GetExtension(const std::string& path)
+	{
+		size_t dot = path.find_last_of('.');
+		if (dot == std::string::npos)
+			return "";
+
+		std::string extension = path.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+		return extension;
+	}
+
+	static void SkipSpaces(const char*& p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+	}
+
+	static void SkipLine(const char*& p, const char* end)
+	{
+		const char* newline = (const char*)std::memchr(p, '\n', end - p);
+		p = newline ? newline + 1 : end;
+	}
+
+	static bool IsLineEnd(const char* p, const char* end)
+	{
+		return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+	}
+
+	template<typename T>
+	static bool ParseNumber(const char*& p, const char* end, T& value)
+	{
+		SkipSpaces(p, end);
+		if (p < end && *p == '+')
+			p++;
+
+		std::from_chars_result result = std::from_chars(p, end, value);
+		if (result.ec != std::errc())
+			return false;
+		p = result.ptr;
+		return true;
+	}
+
+	static bool ParseVec3(const char*& p, const char* end, glm::vec3& value)
+	{
+		return ParseNumber(p, end, value.x) && ParseNumber(p, end, value.y) && ParseNumber(p, end, value.z);
+	}
+
+	// Record type at the start of an OBJ line, "v", "vn", "f" or anything else
+	static bool IsRecord(const char* p, const char* end, const char* record)
+	{
+		size_t length = std::strlen(record);
+		return (size_t)(end - p) > length && std::memcmp(p, record, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+	}
+}
+
+namespace {
+	// One slice of an OBJ file, split at line boundaries so every thread parses whole records
+	struct OBJChunk
+	{
+		const char* Begin = nullptr;
+		const char* End = nullptr;
+
+		size_t PositionCount = 0, NormalCount = 0;
+		size_t PositionBase = 0, NormalBase = 0; // Records in all earlier chunks, to resolve relative indices
+
+		std::vector<uint32_t> Indices;
+		std::vector<uint32_t> NormalIndices;
+		bool MissingNormals = false; // Some face of this chunk has no vn references
+		std::string Error;
+	};
+
+	// Resolves a 1-based or negative (relative to the records read so far) OBJ index to a 0-based one
+	bool ResolveOBJIndex(int64_t index, size_t readSoFar, size_t total, uint32_t& resolved)
+	{
+		int64_t zeroBased = index > 0 ? index - 1 : (int64_t)readSoFar + index;
+		if (index == 0 || zeroBased < 0 || zeroBased >= (int64_t)total)
+			return false;
+		resolved = (uint32_t)zeroBased;
+		return true;
+	}
+
+	void CountOBJRecords(OBJChunk& chunk)
+	{
+		const char* p = chunk.Begin;
+		while (p < chunk.End)
+		{
+			Utils::SkipSpaces(p, chunk.End);
+			if (Utils::IsRecord(p, chunk.End, "v"))
+				chunk.PositionCount++;
+			else if (Utils::IsRecord(p, chunk.End, "vn"))
+				chunk.NormalCount++;
+			Utils::SkipLine(p, chunk.End);
+		}
+	}
+
+	void ParseOBJChunk(OBJChunk& chunk, Mesh& mesh)
+	{
+		const size_t totalPositions = mesh.Positions.size();
+		const size_t totalNormals = mesh.Normals.size();
+		size_t positionsRead = chunk.PositionBase;
+		size_t normalsRead = chunk.NormalBase;
+
+		// Corners of the current polygon, fan triangulated as they come in
+		uint32_t firstPosition = 0, firstNormal = 0, lastPosition = 0, lastNormal = 0;
+
+		const char* end = chunk.End;
+		const char* p = chunk.Begin;
+		while (p < end)
+		{
+			Utils::SkipSpaces(p, end);
+			if (Utils::IsRecord(p, end, "v"))
+			{
+				p += 1;
+				if (!Utils::ParseVec3(p, end, mesh.Positions[positionsRead++]))
+					chunk.Error = "Malformed vertex position";
+			}
+			else if (Utils::IsRecord(p, end, "vn"))
+			{
+				p += 2;
+				if (!Utils::ParseVec3(p, end, mesh.Normals[normalsRead++]))
+					chunk.Error = "Malformed vertex normal";
+			}
+			else if (Utils::IsRecord(p, end, "f"))
+			{
+				p += 1;
+				uint32_t corner = 0;
+				bool faceHasNormals = true;
+				while (true)
+				{
+					Utils::SkipSpaces(p, end);
+					if (Utils::IsLineEnd(p, end))
+						break;
+
+					// v, v/vt, v//vn or v/vt/vn
+					int64_t positionIndex = 0, normalIndex = 0;
+					if (!Utils::ParseNumber(p, end, positionIndex))
+					{
+						chunk.Error = "Malformed face";
+						break;
+					}
+					bool hasNormal = false;
+					if (p < end && *p == '/')
+					{
+						p++;
+						int64_t texcoordIndex;
+						if (p < end && *p != '/')
+							Utils::ParseNumber(p, end, texcoordIndex);
+						if (p < end && *p == '/')
+						{
+							p++;
+							hasNormal = Utils::ParseNumber(p, end, normalIndex);
+						}
+					}
+
+					uint32_t position = 0, normal = 0;
+					if (!ResolveOBJIndex(positionIndex, positionsRead, totalPositions, position) ||
+						(hasNormal && !ResolveOBJIndex(normalIndex, normalsRead, totalNormals, normal)))
+					{
+						chunk.Error = "Face index out of range";
+						break;
+					}
+					faceHasNormals &= hasNormal;
+
+					if (corner == 0)
+					{
+						firstPosition = position;
+						firstNormal = normal;
+					}
+					else if (corner >= 2)
+					{
+						chunk.Indices.insert(chunk.Indices.end(), { firstPosition, lastPosition, position });
+						chunk.NormalIndices.insert(chunk.NormalIndices.end(), { firstNormal, lastNormal, normal });
+					}
+					lastPosition = position;
+					lastNormal = normal;
+					corner++;
+				}
+				chunk.MissingNormals |= !faceHasNormals;
+			}
+
+			if (!chunk.Error.empty())
+				return;
+			Utils::SkipLine(p, end);
+		}
+	}
+}
+
+bool LoadOBJ(const std::string& path, Mesh& mesh, std::string& error)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		error = "Can't open " + path;
+		return false;
+	}
+
+	const char* data = file.GetData();
+	const char* end = data + file.GetSize();
+
+	// Split into chunks that start on a new line
+	const uint32_t chunkCount = Utils::GetLoaderThreadCount(file.GetSize(), 4 << 20);
+	std::vector<OBJChunk> chunks(chunkCount);
+	for (uint32_t i = 0; i < chunkCount; i++)
+	{
+		const char* begin = i == 0 ? data : chunks[i - 1].End;
+		const char* chunkEnd = end;
+		if (i + 1 < chunkCount)
+		{
+			chunkEnd = std::max(begin, data + file.GetSize() * (i + 1) / chunkCount);
+			Utils::SkipLine(chunkEnd, end);
+		}
+		chunks[i].Begin = begin;
+		chunks[i].End = chunkEnd;
+	}
+
+	// First pass counts the vertex records so every chunk knows where its vertices go and how to resolve
+	// relative indices, the second pass parses everything in place
+	Utils::ParallelFor(chunkCount, [&](uint32_t i) { CountOBJRecords(chunks[i]); });
+
+	size_t positionCount = 0, normalCount = 0;
+	for (OBJChunk& chunk : chunks)
+	{
+		chunk.PositionBase = positionCount;
+		chunk.NormalBase = normalCount;
+		positionCount += chunk.PositionCount;
+		normalCount += chunk.NormalCount;
+	}
+
+	mesh = Mesh{};
+	mesh.Positions.resize(positionCount);
+	mesh.Normals.resize(normalCount);
+	Utils::ParallelFor(chunkCount, [&](uint32_t i) { ParseOBJChunk(chunks[i], mesh); });
+
+	size_t indexCount = 0;
+	bool hasNormals = normalCount > 0;
+	for (const OBJChunk& chunk : chunks)
+	{
+		if (!chunk.Error.empty())
+		{
+			error = chunk.Error + " in " + path;
+			mesh = Mesh{};
+			return false;
+		}
+		indexCount += chunk.Indices.size();
+		hasNormals &= !chunk.MissingNormals;
+	}
+
+	// Normals are only kept when every face has them
+	mesh.Indices.resize(indexCount);
+	if (hasNormals)
+		mesh.NormalIndices.resize(indexCount);
+	else
+		mesh.Normals.clear();
+
+	std::vector<size_t> offsets(chunkCount, 0);
+	for (uint32_t i = 1; i < chunkCount; i++)
+		offsets[i] = offsets[i - 1] + chunks[i - 1].Indices.size();
+
+	Utils::ParallelFor(chunkCount, [&](uint32_t i)
+		{
+			std::copy(chunks[i].Indices.begin(), chunks[i].Indices.end(), mesh.Indices.begin() + offsets[i]);
+			if (hasNormals)
+				std::copy(chunks[i].NormalIndices.begin(), chunks[i].NormalIndices.end(), mesh.NormalIndices.begin() + offsets[i]);
+		});
+
+	return true;
+}
+
+namespace {
+	enum class PLYFormat
+	{
+		ASCII, BinaryLittleEndian, BinaryBigEndian
+	};
+
+	enum class PLYType
+	{
+		Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64
+	};
+
+	struct PLYProperty
+	{
+		std::string Name;
+		PLYType Type = PLYType::Float32;
+		bool IsList = false;
+		PLYType CountType = PLYType::UInt8; // Only for lists, Type is then the type of the elements
+	};
+
+	struct PLYElement
+	{
+		std::string Name;
+		size_t Count = 0;
+		std::vector<PLYProperty> Properties;
+
+		// Size of one record in a binary file, 0 when it contains lists and therefore varies
+		size_t GetStride() const;
+		// Fewest bytes a record can take: every value is at least one character in ASCII, and a binary list is at
+		// least its count
+		size_t GetMinRecordSize(bool binary) const;
+		int FindProperty(const char* name) const
+		{
+			for (size_t i = 0; i < Properties.size(); i++)
+			{
+				if (Properties[i].Name == name)
+					return (int)i;
+			}
+			return -1;
+		}
+	};
+
+	bool ParsePLYType(const std::string& name, PLYType& type)
+	{
+		static const struct { const char* Name; PLYType Type; } types[] = {
+			{ "char", PLYType::Int8 }, { "int8", PLYType::Int8 }, { "uchar", PLYType::UInt8 }, { "uint8", PLYType::UInt8 },
+			{ "short", PLYType::Int16 }, { "int16", PLYType::Int16 }, { "ushort", PLYType::UInt16 }, { "uint16", PLYType::UInt16 },
+			{ "int", PLYType::Int32 }, { "int32", PLYType::Int32 }, { "uint", PLYType::UInt32 }, { "uint32", PLYType::UInt32 },
+			{ "float", PLYType::Float32 }, { "float32", PLYType::Float32 }, { "double", PLYType::Float64 }, { "float64", PLYType::Float64 },
+		};
+		for (const auto& entry : types)
+		{
+			if (name == entry.Name)
+			{
+				type = entry.Type;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t GetPLYTypeSize(PLYType type)
+	{
+		switch (type)
+		{
+		case PLYType::Int8: case PLYType::UInt8: return 1;
+		case PLYType::Int16: case PLYType::UInt16: return 2;
+		case PLYType::Int32: case PLYType::UInt32: case PLYType::Float32: return 4;
+		case PLYType::Float64: return 8;
+		}
+		return 0;
+	}
+
+	size_t PLYElement::GetStride() const
+	{
+		size_t stride = 0;
+		for (const PLYProperty& property : Properties)
+		{
+			if (property.IsList)
+				return 0;
+			stride += GetPLYTypeSize(property.Type);
+		}
+		return stride;
+	}
+
+	size_t PLYElement::GetMinRecordSize(bool binary) const
+	{
+		if (!binary)
+			return Properties.size();
+
+		size_t size = 0;
+		for (const PLYProperty& property : Properties)
+			size += GetPLYTypeSize(property.IsList ? property.CountType : property.Type);
+		return size;
+	}
+
+	// Reads one binary value of the given type, the caller checks that it lies inside the file
+	double ReadPLYValue(const char* p, PLYType type, bool bigEndian)
+	{
+		unsigned char bytes[8];
+		size_t size = GetPLYTypeSize(type);
+		std::memcpy(bytes, p, size);
+		if (bigEndian)
+			std::reverse(bytes, bytes + size);
+
+		switch (type)
+		{
+		case PLYType::Int8:    { int8_t v;   std::memcpy(&v, bytes, 1); return v; }
+		case PLYType::UInt8:   { uint8_t v;  std::memcpy(&v, bytes, 1); return v; }
+		case PLYType::Int16:   { int16_t v;  std::memcpy(&v, bytes, 2); return v; }
+		case PLYType::UInt16:  { uint16_t v; std::memcpy(&v, bytes, 2); return v; }
+		case PLYType::Int32:   { int32_t v;  std::memcpy(&v, bytes, 4); return v; }
+		case PLYType::UInt32:  { uint32_t v; std::memcpy(&v, bytes, 4); return v; }
+		case PLYType::Float32: { float v;    std::memcpy(&v, bytes, 4); return v; }
+		case PLYType::Float64: { double v;   std::memcpy(&v, bytes, 8); return v; }
+		}
+		return 0.0;
+	}
+
+	// Sequential reader over the body of a PLY file that hides the ascii/binary difference
+	class PLYReader
+	{
+	public:
+		PLYReader(const char* begin, const char* end, PLYFormat format)
+			: m_Position(begin), m_End(end), m_Format(format) {}
+
+		bool Read(PLYType type, double& value)
+		{
+			if (m_Format == PLYFormat::ASCII)
+			{
+				while (m_Position < m_End && std::isspace((unsigned char)*m_Position))
+					m_Position++;
+				return Utils::ParseNumber(m_Position, m_End, value);
+			}
+
+			size_t size = GetPLYTypeSize(type);
+			if ((size_t)(m_End - m_Position) < size)
+				return false;
+			value = ReadPLYValue(m_Position, type, m_Format == PLYFormat::BinaryBigEndian);
+			m_Position += size;
+			return true;
+		}
+
+		// Skips count fixed size binary records, only valid for binary files
+		bool Skip(size_t count, size_t stride)
+		{
+			if (stride != 0 && (size_t)(m_End - m_Position) / stride < count)
+				return false;
+			m_Position += count * stride;
+			return true;
+		}
+
+		const char* GetPosition() const { return m_Position; }
+		size_t GetRemaining() const { return (size_t)(m_End - m_Position); }
+		bool IsBinary() const { return m_Format != PLYFormat::ASCII; }
+	private:
+		const char* m_Position;
+		const char* m_End;
+		PLYFormat m_Format;
+	};
+
+	bool ParsePLYHeader(const char*& p, const char* end, PLYFormat& format, std::vector<PLYElement>& elements, std::string& error)
+	{
+		auto readLine = [&](std::string& line)
+		{
+			if (p >= end)
+				return false;
+			const char* lineStart = p;
+			Utils::SkipLine(p, end);
+			const char* lineEnd = p;
+			while (lineEnd > lineStart && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r'))
+				lineEnd--;
+			line.assign(lineStart, lineEnd);
+			return true;
+		};
+
+		auto split = [](const std::string& line)
+		{
+			std::vector<std::string> words;
+			size_t i = 0;
+			while (i < line.size())
+			{
+				while (i < line.size() && std::isspace((unsigned char)line[i]))
+					i++;
+				size_t start = i;
+				while (i < line.size() && !std::isspace((unsigned char)line[i]))
+					i++;
+				if (i > start)
+					words.push_back(line.substr(start, i - start));
+			}
+			return words;
+		};
+
+		std::string line;
+		if (!readLine(line) || line != "ply")
+		{
+			error = "Not a PLY file";
+			return false;
+		}
+
+		bool hasFormat = false;
+		while (readLine(line))
+		{
+			std::vector<std::string> words = split(line);
+			if (words.empty() || words[0] == "comment" || words[0] == "obj_info")
+				continue;
+
+			if (words[0] == "end_header")
+			{
+				if (!hasFormat)
+				{
+					error = "PLY header has no format";
+					return false;
+				}
+				return true;
+			}
+
+			if (words[0] == "format" && words.size() >= 2)
+			{
+				if (words[1] == "ascii")
+					format = PLYFormat::ASCII;
+				else if (words[1] == "binary_little_endian")
+					format = PLYFormat::BinaryLittleEndian;
+				else if (words[1] == "binary_big_endian")
+					format = PLYFormat::BinaryBigEndian;
+				else
+				{
+					error = "Unknown PLY format " + words[1];
+					return false;
+				}
+				hasFormat = true;
+			}
+			else if (words[0] == "element" && words.size() >= 3)
+			{
+				PLYElement element;
+				element.Name = words[1];
+				element.Count = std::strtoull(words[2].c_str(), nullptr, 10);
+				elements.push_back(element);
+			}
+			else if (words[0] == "property" && !elements.empty())
+			{
+				PLYProperty property;
+				bool valid;
+				if (words.size() >= 5 && words[1] == "list")
+				{
+					property.IsList = true;
+					property.Name = words[4];
+					valid = ParsePLYType(words[2], property.CountType) && ParsePLYType(words[3], property.Type);
+				}
+				else
+				{
+					valid = words.size() >= 3 && ParsePLYType(words[1], property.Type);
+					if (valid)
+						property.Name = words[2];
+				}
+
+				if (!valid)
+				{
+					error = "Unsupported PLY property: " + line;
+					return false;
+				}
+				elements.back().Properties.push_back(property);
+			}
+			else
+			{
+				error = "Unexpected PLY header line: " + line;
+				return false;
+			}
+		}
+
+		error = "PLY header has no end_header";
+		return false;
+	}
+
+	// Reads one record generically, storing every non-list property value in values. Lists are handed to
+	// onList(propertyIndex, count) which has to consume the list entries from the reader.
+	template<typename ListFn>
+	bool ReadPLYRecord(PLYReader& reader, const PLYElement& element, double* values, ListFn&& onList)
+	{
+		for (size_t i = 0; i < element.Properties.size(); i++)
+		{
+			const PLYProperty& property = element.Properties[i];
+			if (!property.IsList)
+			{
+				if (!reader.Read(property.Type, values[i]))
+					return false;
+				continue;
+			}
+
+			double count;
+			if (!reader.Read(property.CountType, count) || count < 0.0)
+				return false;
+			if (!onList(i, (size_t)count))
+				return false;
+		}
+		return true;
+	}
+}
+
+bool LoadPLY(const std::string& path, Mesh& mesh, std::string& error)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		error = "Can't open " + path;
+		return false;
+	}
+
+	const char* p = file.GetData();
+	const char* end = p + file.GetSize();
+
+	PLYFormat format = PLYFormat::ASCII;
+	std::vector<PLYElement> elements;
+	if (!ParsePLYHeader(p, end, format, elements, error))
+		return false;
+
+	mesh = Mesh{};
+	PLYReader reader(p, end, format);
+	bool hasNormals = false;
+	const std::string truncated = "Truncated or malformed PLY data in " + path;
+
+	for (const PLYElement& element : elements)
+	{
+		// Records without properties take no bytes, there is nothing to read however many the header claims.
+		// Vertices and faces without the properties they need are rejected below.
+		if (element.Properties.empty() && element.Name != "vertex" && element.Name != "face")
+			continue;
+
+		// The header's counts are only trusted as far as the rest of the file could hold them, so a bad count
+		// fails here instead of in the allocations and loops sized from it
+		const size_t minRecordSize = element.GetMinRecordSize(reader.IsBinary());
+		if (element.Count > reader.GetRemaining() / std::max<size_t>(minRecordSize, 1))
+		{
+			error = truncated;
+			return false;
+		}
+
+		std::vector<double> values(element.Properties.size());
+		auto skipList = [&](size_t property, size_t count)
+		{
+			double value;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (!reader.Read(element.Properties[property].Type, value))
+					return false;
+			}
+			return true;
+		};
+
+		if (element.Name == "vertex")
+		{
+			int x = element.FindProperty("x"), y = element.FindProperty("y"), z = element.FindProperty("z");
+			int nx = element.FindProperty("nx"), ny = element.FindProperty("ny"), nz = element.FindProperty("nz");
+			if (x < 0 || y < 0 || z < 0)
+			{
+				error = "PLY vertices have no x, y and z in " + path;
+				return false;
+			}
+			hasNormals = nx >= 0 && ny >= 0 && nz >= 0;
+
+			const size_t stride = element.GetStride();
+			if (reader.IsBinary() && stride > 0)
+			{
+				// Fixed size records, decode them on all cores straight from the mapping
+				const char* vertices = reader.GetPosition();
+				if (!reader.Skip(element.Count, stride))
+				{
+					error = truncated;
+					return false;
+				}
+				mesh.Positions.resize(element.Count);
+				if (hasNormals)
+					mesh.Normals.resize(element.Count);
+
+				std::vector<size_t> offsets(element.Properties.size());
+				for (size_t i = 1; i < offsets.size(); i++)
+					offsets[i] = offsets[i - 1] + GetPLYTypeSize(element.Properties[i - 1].Type);
+
+				const bool bigEndian = format == PLYFormat::BinaryBigEndian;
+				auto readVec3 = [&](const char* record, int a, int b, int c)
+				{
+					return glm::vec3(
+						(float)ReadPLYValue(record + offsets[a], element.Properties[a].Type, bigEndian),
+						(float)ReadPLYValue(record + offsets[b], element.Properties[b].Type, bigEndian),
+						(float)ReadPLYValue(record + offsets[c], element.Properties[c].Type, bigEndian));
+				};
+
+				const uint32_t taskCount = Utils::GetLoaderThreadCount(element.Count * stride, 4 << 20);
+				Utils::ParallelFor(taskCount, [&](uint32_t task)
+					{
+						size_t first = element.Count * task / taskCount;
+						size_t last = element.Count * (task + 1) / taskCount;
+						for (size_t i = first; i < last; i++)
+						{
+							const char* record = vertices + i * stride;
+							mesh.Positions[i] = readVec3(record, x, y, z);
+							if (hasNormals)
+								mesh.Normals[i] = readVec3(record, nx, ny, nz);
+						}
+					});
+			}
+			else
+			{
+				mesh.Positions.resize(element.Count);
+				if (hasNormals)
+					mesh.Normals.resize(element.Count);
+				for (size_t i = 0; i < element.Count; i++)
+				{
+					if (!ReadPLYRecord(reader, element, values.data(), skipList))
+					{
+						error = truncated;
+						return false;
+					}
+					mesh.Positions[i] = glm::vec3((float)values[x], (float)values[y], (float)values[z]);
+					if (hasNormals)
+						mesh.Normals[i] = glm::vec3((float)values[nx], (float)values[ny], (float)values[nz]);
+				}
+			}
+		}
+		else if (element.Name == "face")
+		{
+			int indicesProperty = element.FindProperty("vertex_indices");
+			if (indicesProperty < 0)
+				indicesProperty = element.FindProperty("vertex_index");
+			if (indicesProperty < 0 || !element.Properties[indicesProperty].IsList)
+			{
+				error = "PLY faces have no vertex_indices list in " + path;
+				return false;
+			}
+
+			mesh.Indices.reserve(element.Count * 3);
+			const size_t vertexCount = mesh.Positions.size();
+			bool indexInRange = true;
+			auto readFace = [&](size_t property, size_t count)
+			{
+				if ((int)property != indicesProperty)
+					return skipList(property, count);
+
+				// Fan triangulate the polygon
+				double value;
+				uint32_t corners[2] = {};
+				for (size_t i = 0; i < count; i++)
+				{
+					if (!reader.Read(element.Properties[property].Type, value))
+						return false;
+					if (value < 0.0 || value >= (double)vertexCount)
+					{
+						indexInRange = false;
+						return false;
+					}
+
+					uint32_t index = (uint32_t)value;
+					if (i >= 2)
+						mesh.Indices.insert(mesh.Indices.end(), { corners[0], corners[1], index });
+					corners[i == 0 ? 0 : 1] = index;
+				}
+				return true;
+			};
+
+			for (size_t i = 0; i < element.Count; i++)
+			{
+				if (!ReadPLYRecord(reader, element, values.data(), readFace))
+				{
+					error = indexInRange ? truncated : "PLY face index out of range in " + path;
+					return false;
+				}
+			}
+		}
+		else
+		{
+			const size_t stride = element.GetStride();
+			if (reader.IsBinary() && stride > 0)
+			{
+				if (!reader.Skip(element.Count, stride))
+				{
+					error = truncated;
+					return false;
+				}
+				continue;
+			}
+
+			for (size_t i = 0; i < element.Count; i++)
+			{
+				if (!ReadPLYRecord(reader, element, values.data(), skipList))
+				{
+					error = truncated;
+					return false;
+				}
+			}
+		}
+	}
+
+	// PLY normals are per vertex, so they share the position indices
+	if (hasNormals)
+		mesh.NormalIndices = mesh.Indices;
+	return true;
+}
+
+bool LoadMesh(const std::string& path, Mesh& mesh, std::string& error)
+{
+	std::string extension = Utils::GetExtension(path);
+	bool loaded;
+	if (extension == "obj")
+		loaded = LoadOBJ(path, mesh, error);
+	else if (extension == "ply")
+		loaded = LoadPLY(path, mesh, error);
+	else
+	{
+		error = "Unsupported mesh format: " + path;
+		return false;
+	}
+
+	if (loaded && mesh.GetTriangleCount() == 0)
+	{
+		error = path + " contains no triangles";
+		return false;
+	}
+	return loaded;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "Mesh.h"
+
+// Mesh loaders. Files are memory mapped and large files are parsed on all cores. On failure the functions return
+// false and describe the problem in error.
+
+// Wavefront OBJ. Reads v, vn and f records; polygons are fan triangulated and negative (relative) indices are
+// supported. Texture coordinates, groups and materials are ignored.
+bool LoadOBJ(const std::string& path, Mesh& mesh, std::string& error);
+// Stanford PLY in ascii or binary of either endianness. Reads x/y/z and optional nx/ny/nz of the vertex element
+// and the vertex_indices list of the face element, other elements and properties are skipped.
+bool LoadPLY(const std::string& path, Mesh& mesh, std::string& error);
+
+// Picks the loader from the file extension (.obj or .ply), fails for meshes without triangles
+bool LoadMesh(const std::string& path, Mesh& mesh, std::string& error);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+#include "Ray.h"
+#include "Sampler.h"
+
+// Structure-of-arrays queues for the wavefront path tracer. Every stage reads one queue front to back and the
+// shade stage writes the paths that survive into a fresh queue, so terminated paths never take up a slot in the
+// next bounce. The vectors are cleared rather than freed, after the first frames no stage allocates.
+
+// Paths waiting to be extended by one segment. All paths in a queue are at the same bounce.
+struct PathQueue
+{
+	std::vector<glm::vec3> Origin, Direction;
+	std::vector<glm::vec3> Throughput;
+	// Where the segment started and the pdf of its direction, for the MIS weight of an emitter it hits
+	std::vector<glm::vec3> BouncePosition;
+	std::vector<float> BouncePdf;
+	std::vector<Sampler> Samplers; // Where each path is in its pixel's sample
+	std::vector<uint32_t> Pixel; // Index of the pixel within its tile
+
+	size_t Size() const { return Pixel.size(); }
+
+	void Clear()
+	{
+		Origin.clear(); Direction.clear();
+		Throughput.clear();
+		BouncePosition.clear(); BouncePdf.clear();
+		Samplers.clear();
+		Pixel.clear();
+	}
+
+	void Push(const Ray& ray, const glm::vec3& throughput, const glm::vec3& bouncePosition, float bouncePdf, const Sampler& sampler, uint32_t pixel)
+	{
+		Origin.push_back(ray.Origin); Direction.push_back(ray.Direction);
+		Throughput.push_back(throughput);
+		BouncePosition.push_back(bouncePosition); BouncePdf.push_back(bouncePdf);
+		Samplers.push_back(sampler);
+		Pixel.push_back(pixel);
+	}
+
+	Ray GetRay(size_t i) const { return Ray{ Origin[i], Direction[i] }; }
+};
+
+// Shadow rays of the light samples taken by the shade stage, each adding Contribution to its pixel if nothing is
+// hit before MaxDistance
+struct ShadowQueue
+{
+	std::vector<glm::vec3> Origin, Direction;
+	std::vector<float> MaxDistance;
+	std::vector<glm::vec3> Contribution;
+	std::vector<uint32_t> Pixel;
+
+	size_t Size() const { return Pixel.size(); }
+
+	void Clear()
+	{
+		Origin.clear(); Direction.clear();
+		MaxDistance.clear();
+		Contribution.clear();
+		Pixel.clear();
+	}
+
+	void Push(const Ray& ray, float maxDistance, const glm::vec3& contribution, uint32_t pixel)
+	{
+		Origin.push_back(ray.Origin); Direction.push_back(ray.Direction);
+		MaxDistance.push_back(maxDistance);
+		Contribution.push_back(contribution);
+		Pixel.push_back(pixel);
+	}
+
+	Ray GetRay(size_t i) const { return Ray{ Origin[i], Direction[i] }; }
+};
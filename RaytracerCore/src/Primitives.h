@@ -0,0 +1,176 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+
+#include "Ray.h"
+
+// Structure-of-arrays storage for the primitives the renderer traces against. The editable Scene is compiled
+// into these buffers so that the intersection loops walk contiguous memory without virtual calls.
+
+struct SphereBuffer
+{
+	std::vector<float> CenterX, CenterY, CenterZ;
+	std::vector<float> Radius;
+	std::vector<uint32_t> MaterialIndex;
+
+	size_t Size() const { return Radius.size(); }
+
+	void Clear()
+	{
+		CenterX.clear(); CenterY.clear(); CenterZ.clear();
+		Radius.clear();
+		MaterialIndex.clear();
+	}
+
+	void Push(const glm::vec3& center, float radius, uint32_t material)
+	{
+		CenterX.push_back(center.x); CenterY.push_back(center.y); CenterZ.push_back(center.z);
+		Radius.push_back(radius);
+		MaterialIndex.push_back(material);
+	}
+
+	void Set(size_t i, const glm::vec3& center, float radius, uint32_t material)
+	{
+		CenterX[i] = center.x; CenterY[i] = center.y; CenterZ[i] = center.z;
+		Radius[i] = radius;
+		MaterialIndex[i] = material;
+	}
+
+	glm::vec3 GetCenter(size_t i) const { return { CenterX[i], CenterY[i], CenterZ[i] }; }
+};
+
+struct PlaneBuffer
+{
+	std::vector<float> PointX, PointY, PointZ;
+	std::vector<float> NormalX, NormalY, NormalZ;
+	std::vector<uint32_t> MaterialIndex;
+
+	size_t Size() const { return MaterialIndex.size(); }
+
+	void Clear()
+	{
+		PointX.clear(); PointY.clear(); PointZ.clear();
+		NormalX.clear(); NormalY.clear(); NormalZ.clear();
+		MaterialIndex.clear();
+	}
+
+	void Push(const glm::vec3& point, const glm::vec3& normal, uint32_t material)
+	{
+		PointX.push_back(point.x); PointY.push_back(point.y); PointZ.push_back(point.z);
+		NormalX.push_back(normal.x); NormalY.push_back(normal.y); NormalZ.push_back(normal.z);
+		MaterialIndex.push_back(material);
+	}
+
+	void Set(size_t i, const glm::vec3& point, const glm::vec3& normal, uint32_t material)
+	{
+		PointX[i] = point.x; PointY[i] = point.y; PointZ[i] = point.z;
+		NormalX[i] = normal.x; NormalY[i] = normal.y; NormalZ[i] = normal.z;
+		MaterialIndex[i] = material;
+	}
+
+	glm::vec3 GetPoint(size_t i) const { return { PointX[i], PointY[i], PointZ[i] }; }
+	glm::vec3 GetNormal(size_t i) const { return { NormalX[i], NormalY[i], NormalZ[i] }; }
+};
+
+// Triangles are stored preprocessed for Möller–Trumbore: the first vertex, both edges leaving it and the unit
+// geometric normal, so the intersection loops only do the arithmetic of the test itself
+struct TriangleBuffer
+{
+	std::vector<float> V0X, V0Y, V0Z;
+	std::vector<float> E1X, E1Y, E1Z;
+	std::vector<float> E2X, E2Y, E2Z;
+	std::vector<float> NormalX, NormalY, NormalZ;
+
+	size_t Size() const { return V0X.size(); }
+
+	void Reserve(size_t count)
+	{
+		for (std::vector<float>* channel : { &V0X, &V0Y, &V0Z, &E1X, &E1Y, &E1Z, &E2X, &E2Y, &E2Z, &NormalX, &NormalY, &NormalZ })
+			channel->reserve(count);
+	}
+
+	void Push(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+	{
+		glm::vec3 e1 = v1 - v0;
+		glm::vec3 e2 = v2 - v0;
+		glm::vec3 normal = glm::cross(e1, e2);
+		float length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+
+		V0X.push_back(v0.x); V0Y.push_back(v0.y); V0Z.push_back(v0.z);
+		E1X.push_back(e1.x); E1Y.push_back(e1.y); E1Z.push_back(e1.z);
+		E2X.push_back(e2.x); E2Y.push_back(e2.y); E2Z.push_back(e2.z);
+		NormalX.push_back(normal.x); NormalY.push_back(normal.y); NormalZ.push_back(normal.z);
+	}
+
+	glm::vec3 GetV0(size_t i) const { return { V0X[i], V0Y[i], V0Z[i] }; }
+	glm::vec3 GetE1(size_t i) const { return { E1X[i], E1Y[i], E1Z[i] }; }
+	glm::vec3 GetE2(size_t i) const { return { E2X[i], E2Y[i], E2Z[i] }; }
+	glm::vec3 GetV1(size_t i) const { return GetV0(i) + GetE1(i); }
+	glm::vec3 GetV2(size_t i) const { return GetV0(i) + GetE2(i); }
+	// Unit normal following the winding order, cross(e1, e2)
+	glm::vec3 GetNormal(size_t i) const { return { NormalX[i], NormalY[i], NormalZ[i] }; }
+};
+
+// Scalar intersection routines shared by the scene objects and the compiled scene.
+// All of them return the hit distance along the ray, or a negative value on a miss.
+
+inline float IntersectSphere(const Ray& ray, const glm::vec3& center, float radius)
+{
+	glm::vec3 origin = ray.Origin - center;
+
+	float a = glm::dot(ray.Direction, ray.Direction);
+	float b = 2 * glm::dot(origin, ray.Direction);
+	float c = glm::dot(origin, origin) - radius * radius;
+
+	float d = b * b - 4.f * a * c;
+	if (d < 0)
+		return -1.0f;
+
+	return (-b - glm::sqrt(d)) / (2.f * a);
+}
+
+inline float IntersectPlane(const Ray& ray, const glm::vec3& point, const glm::vec3& normal)
+{
+	float denom = glm::dot(normal, ray.Direction);
+
+	if (glm::abs(denom) < 1e-6)
+		return -1.0f;
+
+	float t = glm::dot(point - ray.Origin, normal) / denom;
+	return t < 0.0f ? -1.0f : t;
+}
+
+// Möller–Trumbore against a triangle given by its first vertex and the edges e1 = v1 - v0, e2 = v2 - v0
+inline float IntersectTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& e1, const glm::vec3& e2)
+{
+	glm::vec3 h = glm::cross(ray.Direction, e2);
+	float a = glm::dot(e1, h);
+
+	if (std::abs(a) < 1e-6)
+		return -1.0f;
+
+	float f = 1.0f / a;
+	glm::vec3 s = ray.Origin - v0;
+	float u = f * glm::dot(s, h);
+
+	if (u < 0.0f || u > 1.0f)
+		return -1.0f;
+
+	glm::vec3 q = glm::cross(s, e1);
+	float v = f * glm::dot(ray.Direction, q);
+
+	if (v < 0.0f || u + v > 1.0f)
+		return -1.0f;
+
+	float t = f * glm::dot(e2, q);
+	return t > 0.0f ? t : -1.0f;
+}
+
+inline float IntersectTriangle(const Ray& ray, const TriangleBuffer& triangles, size_t i)
+{
+	return IntersectTriangle(ray, triangles.GetV0(i), triangles.GetE1(i), triangles.GetE2(i));
+}
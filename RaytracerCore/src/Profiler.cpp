@@ -0,0 +1,190 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace Utils {
+	using Clock = std::chrono::steady_clock;
+
+	static std::atomic<bool> s_Enabled{ false };
+
+	static uint64_t GetProfileTimeNs()
+	{
+		static const Clock::time_point epoch = Clock::now();
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+	}
+
+	// Ring buffer of one thread. Only its thread writes it, publishing each event by bumping Count.
+	struct ThreadProfile
+	{
+		std::unique_ptr<ProfileEvent[]> Events{ new ProfileEvent[MaxProfileEventsPerThread] };
+		std::atomic<uint64_t> Count{ 0 }; // Events ever recorded, the next one goes to Count % MaxProfileEventsPerThread
+		uint32_t Index = 0;
+		std::string Name;
+	};
+
+	struct ProfileRegistry
+	{
+		std::mutex Mutex;
+		// Shared with the threads, so the events of threads that have exited stay around for the export
+		std::vector<std::shared_ptr<ThreadProfile>> Threads;
+		uint32_t NextIndex = 0;
+	};
+
+	static ProfileRegistry& GetProfileRegistry()
+	{
+		static ProfileRegistry registry;
+		return registry;
+	}
+
+	static thread_local std::shared_ptr<ThreadProfile> t_Profile;
+	static thread_local std::string t_ThreadName;
+
+	// Registers the thread's buffer on first use, threads that never record while enabled never allocate one
+	static ThreadProfile& GetThreadProfile()
+	{
+		if (!t_Profile)
+		{
+			auto profile = std::make_shared<ThreadProfile>();
+			ProfileRegistry& registry = GetProfileRegistry();
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			profile->Index = registry.NextIndex++;
+			profile->Name = t_ThreadName;
+			registry.Threads.push_back(profile);
+			t_Profile = std::move(profile);
+		}
+		return *t_Profile;
+	}
+
+	static void WriteJSONString(std::ofstream& file, const char* string)
+	{
+		file << '"';
+		for (const char* c = string; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				file << '\\' << *c;
+			else if ((unsigned char)*c < 0x20)
+			{
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned)*c);
+				file << buffer;
+			}
+			else
+				file << *c;
+		}
+		file << '"';
+	}
+}
+
+void SetProfilerEnabled(bool enabled)
+{
+	// Starts the epoch before the first scope, so no timestamp of a capture is taken before it
+	Utils::GetProfileTimeNs();
+	Utils::s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsProfilerEnabled()
+{
+	return Utils::s_Enabled.load(std::memory_order_relaxed);
+}
+
+void SetProfilerThreadName(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(Utils::GetProfileRegistry().Mutex);
+	Utils::t_ThreadName = name;
+	if (Utils::t_Profile)
+		Utils::t_Profile->Name = name;
+}
+
+void ClearProfile()
+{
+	Utils::ProfileRegistry& registry = Utils::GetProfileRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	// Exited threads are only held by the registry, their buffers go. The live ones start over.
+	auto exited = std::remove_if(registry.Threads.begin(), registry.Threads.end(),
+		[](const std::shared_ptr<Utils::ThreadProfile>& profile) { return profile.use_count() == 1; });
+	registry.Threads.erase(exited, registry.Threads.end());
+	for (const auto& profile : registry.Threads)
+		profile->Count.store(0, std::memory_order_relaxed);
+}
+
+bool WriteChromeTrace(const std::string& path, std::string& error)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		error = "Failed to open " + path + " for writing";
+		return false;
+	}
+
+	Utils::ProfileRegistry& registry = Utils::GetProfileRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	// Complete ("X") events with times in microseconds, and a metadata event naming every thread
+	char buffer[128];
+	bool first = true;
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	for (const auto& profile : registry.Threads)
+	{
+		file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << profile->Index
+			<< ", \"args\": {\"name\": ";
+		first = false;
+		if (profile->Name.empty())
+		{
+			std::snprintf(buffer, sizeof(buffer), "Thread %u", profile->Index);
+			Utils::WriteJSONString(file, buffer);
+		}
+		else
+			Utils::WriteJSONString(file, profile->Name.c_str());
+		file << "}}";
+
+		const uint64_t count = profile->Count.load(std::memory_order_acquire);
+		const uint64_t begin = count > MaxProfileEventsPerThread ? count - MaxProfileEventsPerThread : 0;
+		for (uint64_t i = begin; i < count; i++)
+		{
+			const ProfileEvent& event = profile->Events[i % MaxProfileEventsPerThread];
+			file << ",\n{\"name\": ";
+			Utils::WriteJSONString(file, event.Name);
+			std::snprintf(buffer, sizeof(buffer), ", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+				profile->Index, event.StartNs * 1e-3, event.DurationNs * 1e-3);
+			file << buffer;
+		}
+	}
+	file << "\n]}\n";
+
+	if (!file)
+	{
+		error = "Failed to write " + path;
+		return false;
+	}
+	return true;
+}
+
+ProfileScope::ProfileScope(const char* name) :
+	m_Name(IsProfilerEnabled() ? name : nullptr)
+{
+	if (m_Name)
+		m_StartNs = Utils::GetProfileTimeNs();
+}
+
+ProfileScope::~ProfileScope()
+{
+	if (!m_Name)
+		return;
+
+	const uint64_t endNs = Utils::GetProfileTimeNs();
+	Utils::ThreadProfile& profile = Utils::GetThreadProfile();
+	const uint64_t count = profile.Count.load(std::memory_order_relaxed);
+	ProfileEvent& event = profile.Events[count % MaxProfileEventsPerThread];
+	event.Name = m_Name;
+	event.StartNs = m_StartNs;
+	event.DurationNs = endNs - m_StartNs;
+	profile.Count.store(count + 1, std::memory_order_release);
+}
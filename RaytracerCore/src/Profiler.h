@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Timeline profiler for where a frame's time goes. Scopes record their name, start and duration into a ring buffer
+// owned by the recording thread, so recording takes no locks and never allocates after a thread's first event.
+// Each buffer keeps the most recent MaxProfileEventsPerThread scopes, older ones are overwritten. Recording is off
+// until SetProfilerEnabled(true), and costs one relaxed atomic load per scope while off. Define RT_PROFILE as 0 to
+// compile the scopes out entirely.
+#ifndef RT_PROFILE
+	#define RT_PROFILE 1
+#endif
+
+constexpr uint32_t MaxProfileEventsPerThread = 1u << 16;
+
+struct ProfileEvent
+{
+	const char* Name = nullptr; // Must outlive the profile, scopes are named by string literals
+	uint64_t StartNs = 0;       // Since the profiler's epoch, the first time the clock was read
+	uint64_t DurationNs = 0;
+};
+
+void SetProfilerEnabled(bool enabled);
+bool IsProfilerEnabled();
+// Name of the calling thread in the exported trace, threads without one are listed by their index
+void SetProfilerThreadName(const std::string& name);
+// Drops every recorded event
+void ClearProfile();
+// Writes the recorded events of all threads as Chrome trace_event JSON, which chrome://tracing and the Perfetto UI
+// open. Reads the other threads' buffers without synchronization, so call it between frames.
+bool WriteChromeTrace(const std::string& path, std::string& error);
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name);
+	~ProfileScope();
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+	const char* m_Name;   // nullptr when the profiler was off as the scope began
+	uint64_t m_StartNs = 0;
+};
+
+#if RT_PROFILE
+	#define RT_PROFILE_CONCAT_INNER(a, b) a##b
+	#define RT_PROFILE_CONCAT(a, b) RT_PROFILE_CONCAT_INNER(a, b)
+	#define RT_PROFILE_SCOPE(name) ProfileScope RT_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+	#define RT_PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cfloat>
+
+#include "Ray.h"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+// Bit i set means ray i of the packet is still active
+using RayMask = uint64_t;
+
+// A block of up to 8x8 rays sharing one origin, such as the primary rays of a screen block. Directions are
+// stored as structure-of-arrays so the per-node box test over the packet vectorizes.
+struct RayPacket
+{
+	static constexpr uint32_t MaxSize = 64;
+
+	glm::vec3 Origin{ 0.0f };
+	uint32_t Size = 0;
+
+	alignas(32) float DirectionX[MaxSize];
+	alignas(32) float DirectionY[MaxSize];
+	alignas(32) float DirectionZ[MaxSize];
+	alignas(32) float InvDirectionX[MaxSize];
+	alignas(32) float InvDirectionY[MaxSize];
+	alignas(32) float InvDirectionZ[MaxSize];
+
+	void Push(const glm::vec3& direction)
+	{
+		DirectionX[Size] = direction.x;
+		DirectionY[Size] = direction.y;
+		DirectionZ[Size] = direction.z;
+		InvDirectionX[Size] = 1.0f / direction.x;
+		InvDirectionY[Size] = 1.0f / direction.y;
+		InvDirectionZ[Size] = 1.0f / direction.z;
+		Size++;
+	}
+
+	Ray GetRay(uint32_t i) const { return Ray{ Origin, { DirectionX[i], DirectionY[i], DirectionZ[i] } }; }
+	RayMask GetFullMask() const { return Size == 64 ? ~RayMask(0) : (RayMask(1) << Size) - 1; }
+};
+
+// Index of the lowest active ray in the mask, the mask must not be empty
+inline uint32_t FirstActiveRay(RayMask mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctzll(mask);
+#endif
+}
+
+// Calls fn(rayIndex) for every set bit of the mask
+template<typename Fn>
+inline void ForEachActiveRay(RayMask mask, Fn&& fn)
+{
+	while (mask)
+	{
+		fn(FirstActiveRay(mask));
+		mask &= mask - 1;
+	}
+}
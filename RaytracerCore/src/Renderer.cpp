@@ -0,0 +1,836 @@
+#include "Renderer.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <glm/gtc/constants.hpp>
+
+namespace Utils {
+	// Shadow rays start this far off the surface along its normal, so they can't hit it again
+	static constexpr float ShadowRayOffset = 1e-4f;
+
+	// 1 - cos of the half angle of the cone a sphere subtends, from the squared sine. Written so that it stays
+	// accurate for small, distant spheres where cos is close to 1.
+	static float ConeOneMinusCos(float sinSquared)
+	{
+		return sinSquared / (1.0f + glm::sqrt(glm::max(1.0f - sinSquared, 0.0f)));
+	}
+
+	// Power heuristic with beta = 2 for one sample from each strategy
+	static float PowerHeuristic(float pdf, float otherPdf)
+	{
+		return pdf * pdf / (pdf * pdf + otherPdf * otherPdf);
+	}
+}
+
+void Renderer::Render(const Scene& scene, const Camera& camera)
+{
+	RT_PROFILE_SCOPE("Renderer::Render");
+	m_ActiveScene = &scene;
+	m_ActiveCamera = &camera;
+	m_Settings.PacketSize = glm::clamp(m_Settings.PacketSize, 1u, 8u);
+
+	// Edits made since the last frame are applied by refitting, and whatever was accumulated so far shows a scene
+	// that no longer exists. Starting over also drops the history, which can't be reprojected across an edit.
+	bool sceneChanged;
+	{
+		RT_PROFILE_SCOPE("CompiledScene::Update");
+		sceneChanged = m_CompiledScene.Update(scene);
+	}
+	if (sceneChanged)
+		ResetFrameIndex();
+
+	auto frameStart = std::chrono::high_resolution_clock::now();
+	const bool cameraMoved = camera.GetView() != m_LastView || camera.GetProjection() != m_LastProjection;
+	// Dragging an object previews like moving the camera does
+	m_FrameScale = ChoosePreviewScale(cameraMoved || sceneChanged);
+	const bool preview = m_FrameScale > 1 || (m_Settings.ProgressivePreview && m_FrameBounces != bounces);
+
+	// Frame 1 has nothing accumulated yet, so there's no history to keep
+	m_ReprojectHistory = cameraMoved && m_Settings.TemporalReprojection && m_Settings.Accumulate && m_FrameIndex > 1 && !preview;
+	if (m_ReprojectHistory)
+	{
+		std::swap(m_Accumulation, m_History);
+		m_HistoryViewProjection = m_LastProjection * m_LastView;
+		m_HistoryPosition = m_LastPosition;
+	}
+	m_LastView = camera.GetView();
+	m_LastProjection = camera.GetProjection();
+	m_LastPosition = camera.GetPosition();
+
+	m_Settings.TileSize = glm::clamp(m_Settings.TileSize, 8u, 256u);
+	m_Scheduler.SetThreadCount(m_Settings.ThreadCount);
+
+	if ((m_FrameIndex == 1 || m_ReprojectHistory) && !preview)
+		m_Accumulation.Clear(m_Scheduler, m_Settings.TileSize);
+	m_ThreadRayCounts.assign(m_Scheduler.GetThreadCount(), 0);
+	m_ThreadActivePixels.assign(m_Scheduler.GetThreadCount(), 0);
+	m_ThreadReprojectedPixels.assign(m_Scheduler.GetThreadCount(), 0);
+	// Resized rather than reassigned, so the queues keep their capacity from frame to frame
+	m_ThreadWavefronts.resize(m_Scheduler.GetThreadCount());
+	m_Tonemapper.Update();
+
+	// Counters only ever grow, the frame's share is the difference. Summing them on request rather than resetting
+	// leaves other users of the counters, like the benchmarks, undisturbed.
+#if RT_STATS
+	const TraceCounters countersBefore = CollectTraceCounters();
+#endif
+	auto start = std::chrono::high_resolution_clock::now();
+
+	{
+		RT_PROFILE_SCOPE("Trace");
+		m_Scheduler.Run(m_Width, m_Height, m_Settings.TileSize,
+			[this, preview](const Tile& tile, uint32_t threadIndex)
+			{
+				// Packets share one origin, which a thin lens camera doesn't have
+				if (preview)
+					RenderPreviewTile(tile, threadIndex);
+				else if (m_Settings.Wavefront)
+					RenderWavefrontTile(tile, threadIndex);
+				else if (m_Settings.PacketTracing && !m_ActiveCamera->HasDepthOfField())
+					RenderPacketTile(tile, threadIndex);
+				else
+					RenderTile(tile, threadIndex);
+			});
+	}
+
+	m_ThreadStats = m_Scheduler.GetStats();
+
+	uint64_t raysTraced = 0;
+	for (uint64_t rayCount : m_ThreadRayCounts)
+		raysTraced += rayCount;
+	m_ActivePixelCount = 0;
+	for (uint32_t activePixels : m_ThreadActivePixels)
+		m_ActivePixelCount += activePixels;
+	m_ReprojectedPixelCount = 0;
+	for (uint32_t reprojectedPixels : m_ThreadReprojectedPixels)
+		m_ReprojectedPixelCount += reprojectedPixels;
+
+	float seconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+	m_MraysPerSecond = seconds > 0.0f ? (float)raysTraced / seconds * 1e-6f : 0.0f;
+
+	m_FrameStats = FrameStats{};
+	m_FrameStats.FrameIndex = preview ? 1 : m_FrameIndex;
+	m_FrameStats.TraceMs = seconds * 1000.0f;
+	m_FrameStats.MraysPerSecond = m_MraysPerSecond;
+	m_FrameStats.RayCount = raysTraced;
+	float busyMs = 0.0f;
+	for (const WorkerStats& stats : m_ThreadStats)
+	{
+		m_FrameStats.TileCount += stats.TileCount;
+		m_FrameStats.MaxTileMs = std::max(m_FrameStats.MaxTileMs, stats.MaxTileMs);
+		busyMs += stats.BusyMs;
+	}
+	m_FrameStats.AverageTileMs = m_FrameStats.TileCount > 0 ? busyMs / m_FrameStats.TileCount : 0.0f;
+#if RT_STATS
+	m_FrameStats.Counters = CollectTraceCounters();
+	m_FrameStats.Counters -= countersBefore;
+#endif
+
+	// Previews write the display image while tracing, other frames only have a new accumulation to resolve
+	m_ResolveMs = 0.0f;
+	if (m_Settings.ResolveEveryFrame && !preview)
+	{
+		if (m_Settings.Denoise)
+			Denoise();
+		else
+			Resolve();
+	}
+	m_LastFrameMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+	m_FrameStats.FrameMs = m_LastFrameMs;
+
+	// Previews leave the accumulation alone, it starts over with the first full resolution frame
+	if (m_Settings.Accumulate && !preview)
+		m_FrameIndex++;
+	else
+		m_FrameIndex = 1;
+}
+
+uint32_t Renderer::ChoosePreviewScale(bool moving)
+{
+	constexpr uint32_t MaxScale = 8;
+
+	m_FrameBounces = bounces;
+
+	// Reprojection keeps the image while the camera moves, so there's nothing left for a preview to cover
+	if (!m_Settings.ProgressivePreview || m_Settings.TemporalReprojection)
+	{
+		m_RefineScale = 1;
+		return 1;
+	}
+
+	if (moving)
+	{
+		// Pick the block size from how long the last moving frame took, halving the block quadruples the work.
+		// Only shrink when the smaller block still fits the budget with some margin.
+		if (m_FrameScale == m_MotionScale && m_LastFrameMs > 0.0f)
+		{
+			if (m_LastFrameMs > m_Settings.FrameBudgetMs && m_MotionScale < MaxScale)
+				m_MotionScale *= 2;
+			else if (m_LastFrameMs * 4.0f < m_Settings.FrameBudgetMs * 0.75f && m_MotionScale > 1)
+				m_MotionScale /= 2;
+		}
+
+		m_FrameBounces = glm::min(glm::max(m_Settings.PreviewBounces, 1u), bounces);
+		m_RefineScale = m_MotionScale;
+		return m_MotionScale;
+	}
+
+	// The camera stopped, refine one level per frame with full bounces until accumulation takes over
+	if (m_RefineScale > 1)
+	{
+		m_RefineScale /= 2;
+		if (m_RefineScale > 1)
+			return m_RefineScale;
+	}
+	return 1;
+}
+
+void Renderer::OnResize(uint32_t width, uint32_t height)
+{
+	if (m_ImageData.Data() && m_Width == width && m_Height == height)
+		return;
+
+	m_Width = width;
+	m_Height = height;
+	ResetFrameIndex();
+
+	// Buffers only reallocate when the image outgrows them. Nothing needs clearing here: the accumulation is
+	// cleared by the first frame, and the history is only read after a swap made it a filled accumulation.
+	m_ImageData.Resize((size_t)width * height);
+	m_DenoisedData.Resize((size_t)width * height);
+	m_Accumulation.Resize(width, height);
+	m_History.Resize(width, height);
+}
+
+void Renderer::RenderTile(const Tile& tile, uint32_t threadIndex)
+{
+	uint32_t rayCount = 0, activePixels = 0, reprojectedPixels = 0;
+	for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+	{
+		for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+		{
+			if (!IsPixelActive(x, y))
+				continue;
+
+			AOVSample aov;
+			glm::vec4 col = RayGen(x, y, rayCount, nullptr, &aov);
+			if (m_ReprojectHistory && ReprojectPixel(x, y, aov))
+				reprojectedPixels++;
+			AccumulatePixel(x, y, col, aov);
+			activePixels++;
+		}
+	}
+
+	m_ThreadRayCounts[threadIndex] += rayCount;
+	m_ThreadActivePixels[threadIndex] += activePixels;
+	m_ThreadReprojectedPixels[threadIndex] += reprojectedPixels;
+}
+
+void Renderer::RenderPacketTile(const Tile& tile, uint32_t threadIndex)
+{
+	const uint32_t packetSize = m_Settings.PacketSize;
+
+	RayPacket packet;
+	HitRecord hits[RayPacket::MaxSize];
+	uint32_t pixelX[RayPacket::MaxSize], pixelY[RayPacket::MaxSize];
+	uint32_t rayCount = 0, activePixels = 0, reprojectedPixels = 0;
+
+	for (uint32_t blockY = tile.MinY; blockY < tile.MaxY; blockY += packetSize)
+	{
+		const uint32_t blockHeight = std::min(packetSize, tile.MaxY - blockY);
+		for (uint32_t blockX = tile.MinX; blockX < tile.MaxX; blockX += packetSize)
+		{
+			const uint32_t blockWidth = std::min(packetSize, tile.MaxX - blockX);
+
+			packet.Origin = m_ActiveCamera->GetPosition();
+			packet.Size = 0;
+			for (uint32_t y = blockY; y < blockY + blockHeight; y++)
+			{
+				for (uint32_t x = blockX; x < blockX + blockWidth; x++)
+				{
+					// Converged pixels are left out, so the packet only holds the rays still worth tracing
+					if (!IsPixelActive(x, y))
+						continue;
+
+					// RayGen draws the same jitter from the pixel's sampler, so both paths trace identical rays
+					Sampler sampler = CreatePixelSampler(x, y);
+					pixelX[packet.Size] = x;
+					pixelY[packet.Size] = y;
+					packet.Push(GenerateCameraRay(x, y, sampler).Direction);
+				}
+			}
+			if (packet.Size == 0)
+				continue;
+
+			std::fill(hits, hits + packet.Size, HitRecord{});
+			m_CompiledScene.IntersectPacket(packet, hits);
+			rayCount += packet.Size;
+			RT_STAT_ADD(PrimaryRays, packet.Size);
+			activePixels += packet.Size;
+
+			// Continue every path from its packet hit, the diffuse bounces are incoherent so they go one ray at a time
+			for (uint32_t i = 0; i < packet.Size; i++)
+			{
+				uint32_t x = pixelX[i];
+				uint32_t y = pixelY[i];
+
+				Ray ray = packet.GetRay(i);
+				HitPayload primaryHit = hits[i].Distance == FLT_MAX ? Miss(ray) : ClosestHit(ray, hits[i]);
+				AOVSample aov;
+				glm::vec4 col = RayGen(x, y, rayCount, &primaryHit, &aov);
+				if (m_ReprojectHistory && ReprojectPixel(x, y, aov))
+					reprojectedPixels++;
+				AccumulatePixel(x, y, col, aov);
+			}
+		}
+	}
+
+	m_ThreadRayCounts[threadIndex] += rayCount;
+	m_ThreadActivePixels[threadIndex] += activePixels;
+	m_ThreadReprojectedPixels[threadIndex] += reprojectedPixels;
+}
+
+void Renderer::RenderWavefrontTile(const Tile& tile, uint32_t threadIndex)
+{
+	WavefrontState& state = m_ThreadWavefronts[threadIndex];
+	const uint32_t tileWidth = tile.MaxX - tile.MinX;
+	const uint32_t pixelCount = tileWidth * (tile.MaxY - tile.MinY);
+	state.Radiance.assign(pixelCount, glm::vec3(0.0f));
+	state.AOVs.assign(pixelCount, AOVSample{});
+
+	uint32_t rayCount = 0, reprojectedPixels = 0;
+	GeneratePaths(tile, state);
+	for (uint32_t bounce = 0; bounce < m_FrameBounces && state.Paths.Size() > 0; bounce++)
+	{
+		ExtendPaths(state, rayCount);
+		if (bounce == 0)
+			RT_STAT_ADD(PrimaryRays, state.Paths.Size());
+		else
+			RT_STAT_ADD(SecondaryRays, state.Paths.Size());
+		ShadePaths(state, bounce);
+		ConnectShadowRays(state, rayCount);
+		std::swap(state.Paths, state.NextPaths);
+	}
+
+	for (uint32_t pixel : state.ActivePixels)
+	{
+		const uint32_t x = tile.MinX + pixel % tileWidth;
+		const uint32_t y = tile.MinY + pixel / tileWidth;
+		const AOVSample& aov = state.AOVs[pixel];
+		if (m_ReprojectHistory && ReprojectPixel(x, y, aov))
+			reprojectedPixels++;
+		AccumulatePixel(x, y, glm::vec4(state.Radiance[pixel], 1.0f), aov);
+	}
+
+	m_ThreadRayCounts[threadIndex] += rayCount;
+	m_ThreadActivePixels[threadIndex] += (uint32_t)state.ActivePixels.size();
+	m_ThreadReprojectedPixels[threadIndex] += reprojectedPixels;
+}
+
+void Renderer::GeneratePaths(const Tile& tile, WavefrontState& state)
+{
+	const uint32_t tileWidth = tile.MaxX - tile.MinX;
+	state.Paths.Clear();
+	state.ActivePixels.clear();
+	for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+	{
+		for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+		{
+			if (!IsPixelActive(x, y))
+				continue;
+
+			// Same sampler and camera ray as RayGen, so both modes trace the same primary rays
+			const uint32_t pixel = (x - tile.MinX) + (y - tile.MinY) * tileWidth;
+			Sampler sampler = CreatePixelSampler(x, y);
+			const Ray ray = GenerateCameraRay(x, y, sampler);
+			state.Paths.Push(ray, glm::vec3(1.0f), glm::vec3(0.0f), 0.0f, sampler, pixel);
+			state.ActivePixels.push_back(pixel);
+		}
+	}
+}
+
+void Renderer::ExtendPaths(WavefrontState& state, uint32_t& rayCount)
+{
+	const PathQueue& paths = state.Paths;
+	const size_t pathCount = paths.Size();
+	state.Hits.resize(pathCount);
+	for (size_t i = 0; i < pathCount; i++)
+		m_CompiledScene.Intersect(paths.GetRay(i), state.Hits[i]);
+	rayCount += (uint32_t)pathCount;
+}
+
+void Renderer::ShadePaths(WavefrontState& state, uint32_t bounce)
+{
+	const PathQueue& paths = state.Paths;
+	PathQueue& nextPaths = state.NextPaths;
+	nextPaths.Clear();
+	state.ShadowRays.Clear();
+
+	const bool sampleLights = m_Settings.NextEventEstimation && !m_CompiledScene.GetEmitters().empty();
+	const bool lastBounce = bounce + 1 >= m_FrameBounces;
+	const bool russianRoulette = m_Settings.RussianRoulette && bounce + 1 >= m_Settings.RussianRouletteDepth;
+
+	for (size_t i = 0; i < paths.Size(); i++)
+	{
+		const Ray ray = paths.GetRay(i);
+		const HitRecord& hit = state.Hits[i];
+		const uint32_t pixel = paths.Pixel[i];
+
+		// The sky is black, a miss only ends the path
+		if (hit.Distance == FLT_MAX)
+		{
+			if (bounce == 0)
+				state.AOVs[pixel].Position = ray.Origin + ray.Direction * MissDepth;
+			RT_STAT_PATH_LENGTH(bounce);
+			continue;
+		}
+
+		const HitPayload payload = ClosestHit(ray, hit);
+		const Material& material = m_ActiveScene->materials[payload.MaterialIndex];
+		if (bounce == 0)
+		{
+			AOVSample& aov = state.AOVs[pixel];
+			aov.Albedo = material.Albedo;
+			aov.Normal = payload.WorldNormal;
+			aov.Depth = payload.HitDistance;
+			aov.Position = payload.WorldPosition;
+		}
+
+		// Weighted the same way as in RayGen
+		float emissionWeight = 1.0f;
+		if (sampleLights && bounce > 0 && payload.EmitterIndex != CompiledScene::NoEmitter)
+			emissionWeight = Utils::PowerHeuristic(paths.BouncePdf[i], GetEmitterPdf(payload.EmitterIndex, paths.BouncePosition[i]));
+
+		glm::vec3 throughput = paths.Throughput[i] * material.Albedo;
+		state.Radiance[pixel] += material.getEmission() * throughput * emissionWeight;
+
+		Sampler sampler = paths.Samplers[i];
+		if (sampleLights)
+		{
+			Ray shadowRay;
+			float shadowDistance;
+			glm::vec3 contribution;
+			if (SampleEmitter(payload, sampler, shadowRay, shadowDistance, contribution))
+				state.ShadowRays.Push(shadowRay, shadowDistance, contribution * throughput, pixel);
+		}
+
+		if (lastBounce)
+		{
+			RT_STAT_PATH_LENGTH(bounce + 1);
+			continue;
+		}
+
+		const Ray bounceRay{ payload.WorldPosition + FLT_MIN * payload.WorldNormal, SampleCosineHemisphere(payload.WorldNormal, sampler.Next2D()) };
+		const float bouncePdf = glm::max(glm::dot(payload.WorldNormal, bounceRay.Direction), 0.0f) * glm::one_over_pi<float>();
+
+		// Dim paths carry little light, end them with the chance of losing it and boost the survivors to stay unbiased
+		if (russianRoulette)
+		{
+			const float survival = glm::min(glm::max(throughput.x, glm::max(throughput.y, throughput.z)), 0.95f);
+			if (sampler.Next1D() >= survival)
+			{
+				RT_STAT_PATH_LENGTH(bounce + 1);
+				continue;
+			}
+			throughput /= survival;
+		}
+
+		nextPaths.Push(bounceRay, throughput, payload.WorldPosition, bouncePdf, sampler, pixel);
+	}
+}
+
+void Renderer::ConnectShadowRays(WavefrontState& state, uint32_t& rayCount)
+{
+	const ShadowQueue& shadowRays = state.ShadowRays;
+	for (size_t i = 0; i < shadowRays.Size(); i++)
+	{
+		if (!m_CompiledScene.IsOccluded(shadowRays.GetRay(i), shadowRays.MaxDistance[i]))
+			state.Radiance[shadowRays.Pixel[i]] += shadowRays.Contribution[i];
+	}
+	rayCount += (uint32_t)shadowRays.Size();
+	RT_STAT_ADD(ShadowRays, shadowRays.Size());
+}
+
+void Renderer::RenderPreviewTile(const Tile& tile, uint32_t threadIndex)
+{
+	const uint32_t scale = m_FrameScale;
+	uint32_t rayCount = 0, activePixels = 0;
+
+	// Blocks are aligned to the image rather than the tile, each belongs to the tile holding its first pixel
+	const uint32_t firstX = (tile.MinX + scale - 1) / scale * scale;
+	const uint32_t firstY = (tile.MinY + scale - 1) / scale * scale;
+	for (uint32_t blockY = firstY; blockY < tile.MaxY; blockY += scale)
+	{
+		const uint32_t blockMaxY = std::min(blockY + scale, m_Height);
+		for (uint32_t blockX = firstX; blockX < tile.MaxX; blockX += scale)
+		{
+			const uint32_t blockMaxX = std::min(blockX + scale, m_Width);
+
+			// Sample the middle of the block and fill all of it, a nearest neighbour upscale
+			glm::vec4 col = RayGen((blockX + blockMaxX) / 2, (blockY + blockMaxY) / 2, rayCount);
+			uint32_t rgba = m_Tonemapper.Resolve(glm::vec3(col));
+			for (uint32_t y = blockY; y < blockMaxY; y++)
+				std::fill(m_ImageData.Data() + blockX + y * m_Width, m_ImageData.Data() + blockMaxX + y * m_Width, rgba);
+			activePixels++;
+		}
+	}
+
+	m_ThreadRayCounts[threadIndex] += rayCount;
+	m_ThreadActivePixels[threadIndex] += activePixels;
+}
+
+bool Renderer::IsPixelActive(uint32_t x, uint32_t y) const
+{
+	if (!m_Settings.AdaptiveSampling || !m_Settings.Accumulate)
+		return true;
+
+	const uint32_t index = x + y * m_Width;
+	const uint32_t sampleCount = m_Accumulation.SampleCount[index];
+	if (sampleCount < glm::max(m_Settings.MinSamples, 2u))
+		return true;
+
+	// Standard error of the mean from the unbiased sample variance
+	const float n = (float)sampleCount;
+	const glm::vec2 sums = m_Accumulation.Variance[index];
+	const float mean = sums.x / n;
+	const float variance = glm::max((sums.y - n * mean * mean) / (n - 1.0f), 0.0f);
+	return variance / n > m_Settings.NoiseThreshold * m_Settings.NoiseThreshold;
+}
+
+void Renderer::AccumulatePixel(uint32_t x, uint32_t y, const glm::vec4& col, const AOVSample& aov)
+{
+	const uint32_t index = x + y * m_Width;
+	m_Accumulation.Color[index] += glm::vec3(col);
+	m_Accumulation.SampleCount[index]++;
+	m_Accumulation.Albedo[index] += aov.Albedo;
+	m_Accumulation.Normal[index] += aov.Normal;
+	m_Accumulation.Depth[index] += aov.Depth;
+
+	// The display clamps, so brighter samples can't make a pixel look any noisier than white
+	float luminance = glm::min(glm::dot(glm::vec3(col), glm::vec3(0.2126f, 0.7152f, 0.0722f)), 1.0f);
+	m_Accumulation.Variance[index] += glm::vec2(luminance, luminance * luminance);
+}
+
+bool Renderer::ReprojectPixel(uint32_t x, uint32_t y, const AOVSample& aov)
+{
+	// Where the sample's first hit was on screen last frame, in pixels with pixel centres on .5
+	const glm::vec4 clip = m_HistoryViewProjection * glm::vec4(aov.Position, 1.0f);
+	if (clip.w <= 0.0f)
+		return false;
+	const glm::vec2 previous = (glm::vec2(clip.x, clip.y) / clip.w * 0.5f + 0.5f) * glm::vec2((float)m_Width, (float)m_Height) - 0.5f;
+	// Also rejects NaN
+	if (!(previous.x > -1.0f && previous.x < (float)m_Width && previous.y > -1.0f && previous.y < (float)m_Height))
+		return false;
+
+	const bool miss = aov.Depth >= MissDepth;
+	const float depth = glm::length(aov.Position - m_HistoryPosition);
+
+	// Bilinear over the four surrounding pixels, leaving out the ones that saw a different surface. Pixels keep
+	// sums, so their averages are blended and then weighted by the blended sample count.
+	const int32_t x0 = (int32_t)glm::floor(previous.x);
+	const int32_t y0 = (int32_t)glm::floor(previous.y);
+	const glm::vec2 fraction = previous - glm::vec2((float)x0, (float)y0);
+
+	glm::vec3 color(0.0f);
+	glm::vec2 variance(0.0f);
+	glm::vec3 albedo(0.0f), normal(0.0f);
+	float sampleCount = 0.0f, weightSum = 0.0f;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		const int32_t tapX = x0 + (int32_t)(i & 1);
+		const int32_t tapY = y0 + (int32_t)(i >> 1);
+		if (tapX < 0 || tapY < 0 || tapX >= (int32_t)m_Width || tapY >= (int32_t)m_Height)
+			continue;
+
+		const float weight = ((i & 1) ? fraction.x : 1.0f - fraction.x) * ((i >> 1) ? fraction.y : 1.0f - fraction.y);
+		const uint32_t index = (uint32_t)tapX + (uint32_t)tapY * m_Width;
+		const uint32_t tapSamples = m_History.SampleCount[index];
+		if (weight <= 0.0f || tapSamples == 0)
+			continue;
+
+		const float invSamples = 1.0f / (float)tapSamples;
+		if (glm::abs(m_History.Depth[index] * invSamples - depth) > m_Settings.DepthTolerance * depth)
+			continue;
+		const glm::vec3 tapNormal = m_History.Normal[index] * invSamples;
+		if (!miss && glm::dot(tapNormal, aov.Normal) < m_Settings.NormalTolerance * glm::length(tapNormal))
+			continue;
+
+		color += m_History.Color[index] * (invSamples * weight);
+		variance += m_History.Variance[index] * (invSamples * weight);
+		albedo += m_History.Albedo[index] * (invSamples * weight);
+		normal += tapNormal * weight;
+		sampleCount += (float)tapSamples * weight;
+		weightSum += weight;
+	}
+
+	if (weightSum <= 0.0f)
+		return false;
+	const uint32_t historySamples = glm::min((uint32_t)(sampleCount / weightSum + 0.5f), m_Settings.MaxHistorySamples);
+	if (historySamples == 0)
+		return false;
+
+	// The blended averages count as historySamples samples. The depth is the new sample's, as the history's was
+	// measured from where the camera was.
+	const float scale = (float)historySamples / weightSum;
+	const uint32_t index = x + y * m_Width;
+	m_Accumulation.Color[index] = color * scale;
+	m_Accumulation.SampleCount[index] = historySamples;
+	m_Accumulation.Variance[index] = variance * scale;
+	m_Accumulation.Albedo[index] = albedo * scale;
+	m_Accumulation.Normal[index] = normal * scale;
+	m_Accumulation.Depth[index] = aov.Depth * (float)historySamples;
+	return true;
+}
+
+void Renderer::Resolve()
+{
+	RT_PROFILE_SCOPE("Renderer::Resolve");
+	auto start = std::chrono::high_resolution_clock::now();
+	m_Tonemapper.Update();
+
+	const bool showActivePixels = m_Settings.ShowActivePixels && m_Settings.AdaptiveSampling && m_Settings.Accumulate;
+	m_Scheduler.Run(m_Width, m_Height, m_Settings.TileSize,
+		[this, showActivePixels](const Tile& tile, uint32_t)
+		{
+			for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				const size_t row = tile.MinX + (size_t)y * m_Width;
+				m_Tonemapper.Resolve(m_Accumulation.Color.Data() + row, m_Accumulation.SampleCount.Data() + row, m_ImageData.Data() + row, tile.MaxX - tile.MinX);
+				if (!showActivePixels)
+					continue;
+
+				// Blend the pixels that will be sampled next frame halfway to red
+				for (uint32_t x = tile.MinX; x < tile.MaxX; x++)
+				{
+					uint32_t& rgba = m_ImageData[x + (size_t)y * m_Width];
+					if (IsPixelActive(x, y))
+						rgba = (((rgba & 0xfefefeu) >> 1) + 0x7fu) | 0xff000000u;
+				}
+			}
+		});
+
+	m_ResolveMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Renderer::Denoise()
+{
+	RT_PROFILE_SCOPE("Renderer::Denoise");
+	auto start = std::chrono::high_resolution_clock::now();
+
+	DenoiserInput input;
+	input.Color = m_Accumulation.Color.Data();
+	input.Albedo = m_Accumulation.Albedo.Data();
+	input.Normal = m_Accumulation.Normal.Data();
+	input.Depth = m_Accumulation.Depth.Data();
+	input.SampleCounts = m_Accumulation.SampleCount.Data();
+	input.Width = m_Width;
+	input.Height = m_Height;
+	m_Denoiser.Denoise(input, m_DenoisedData.Data(), m_Scheduler);
+
+	m_Tonemapper.Update();
+	m_Scheduler.Run(m_Width, m_Height, m_Settings.TileSize,
+		[this](const Tile& tile, uint32_t)
+		{
+			for (uint32_t y = tile.MinY; y < tile.MaxY; y++)
+			{
+				const size_t row = tile.MinX + (size_t)y * m_Width;
+				m_Tonemapper.Resolve(m_DenoisedData.Data() + row, m_ImageData.Data() + row, tile.MaxX - tile.MinX);
+			}
+		});
+
+	m_DenoiseMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+glm::vec4 Renderer::RayGen(uint32_t x, uint32_t y, uint32_t& rayCount, const HitPayload* primaryHit, AOVSample* aov)
+{
+	Sampler sampler = CreatePixelSampler(x, y);
+	Ray ray = GenerateCameraRay(x, y, sampler);
+
+	glm::vec3 light = glm::vec3(0.0f);
+	glm::vec3 throughput(1.0f);
+
+	const bool sampleLights = m_Settings.NextEventEstimation && !m_CompiledScene.GetEmitters().empty();
+	// Where the current ray left from and the pdf of its direction, to weigh the emitter it may hit against
+	// having sampled that emitter directly from there
+	glm::vec3 bouncePosition(0.0f);
+	float bouncePdf = 0.0f;
+	uint32_t pathLength = 0;
+
+	for (uint32_t i = 0; i < m_FrameBounces; i++)
+	{
+		Renderer::HitPayload payload;
+		if (i == 0 && primaryHit)
+		{
+			payload = *primaryHit;
+		}
+		else
+		{
+			payload = TraceRay(ray);
+			rayCount++;
+			if (i == 0)
+				RT_STAT_ADD(PrimaryRays, 1);
+			else
+				RT_STAT_ADD(SecondaryRays, 1);
+		}
+
+		if (payload.HitDistance < 0.0f)
+		{
+			if (i == 0 && aov)
+				aov->Position = ray.Origin + ray.Direction * MissDepth;
+
+			glm::vec3 skyColor = glm::vec3(0.0f, 0.0f, 0.0f);
+			light += skyColor * throughput;
+			break;
+		}
+
+		pathLength++;
+		const Material& material = m_ActiveScene->materials[payload.MaterialIndex];
+		if (i == 0 && aov)
+		{
+			aov->Albedo = material.Albedo;
+			aov->Normal = payload.WorldNormal;
+			aov->Depth = payload.HitDistance;
+			aov->Position = payload.WorldPosition;
+		}
+
+		// Emitters that direct light sampling could have picked only count with their MIS weight, the rest of it
+		// was already added by the light sample at the previous bounce
+		float emissionWeight = 1.0f;
+		if (sampleLights && i > 0 && payload.EmitterIndex != CompiledScene::NoEmitter)
+			emissionWeight = Utils::PowerHeuristic(bouncePdf, GetEmitterPdf(payload.EmitterIndex, bouncePosition));
+
+		throughput *= material.Albedo;
+		light += material.getEmission() * throughput * emissionWeight;
+
+		if (sampleLights)
+			light += SampleDirectLight(payload, sampler, rayCount) * throughput;
+
+		ray.Origin = payload.WorldPosition + FLT_MIN * payload.WorldNormal;
+		ray.Direction = SampleCosineHemisphere(payload.WorldNormal, sampler.Next2D());
+
+		bouncePosition = payload.WorldPosition;
+		bouncePdf = glm::max(glm::dot(payload.WorldNormal, ray.Direction), 0.0f) * glm::one_over_pi<float>();
+	}
+	RT_STAT_PATH_LENGTH(pathLength);
+
+	return glm::vec4(light, 1.0f);
+}
+
+glm::vec3 Renderer::SampleDirectLight(const HitPayload& payload, Sampler& sampler, uint32_t& rayCount)
+{
+	Ray shadowRay;
+	float shadowDistance;
+	glm::vec3 contribution;
+	if (!SampleEmitter(payload, sampler, shadowRay, shadowDistance, contribution))
+		return glm::vec3(0.0f);
+
+	rayCount++;
+	RT_STAT_ADD(ShadowRays, 1);
+	if (m_CompiledScene.IsOccluded(shadowRay, shadowDistance))
+		return glm::vec3(0.0f);
+	return contribution;
+}
+
+bool Renderer::SampleEmitter(const HitPayload& payload, Sampler& sampler, Ray& shadowRay, float& shadowDistance, glm::vec3& contribution) const
+{
+	// Pick an emitter by power, then a direction uniformly inside the cone of directions its sphere covers
+	const float selection = sampler.Next1D();
+	const glm::vec2 u = sampler.Next2D();
+	const Emitter& emitter = m_CompiledScene.GetEmitters()[m_CompiledScene.PickEmitter(selection)];
+
+	const glm::vec3 toCenter = emitter.Center - payload.WorldPosition;
+	const float distanceSquared = glm::dot(toCenter, toCenter);
+	const float radiusSquared = emitter.Radius * emitter.Radius;
+	// Points on or inside the sphere see it in every direction, leave those to the bounces
+	if (distanceSquared <= radiusSquared * 1.0001f)
+		return false;
+
+	const float distance = glm::sqrt(distanceSquared);
+	const float sinSquaredMax = radiusSquared / distanceSquared;
+	const float oneMinusCosMax = Utils::ConeOneMinusCos(sinSquaredMax);
+
+	const float cosTheta = 1.0f - u.x * oneMinusCosMax;
+	const float sinTheta = glm::sqrt(glm::max(1.0f - cosTheta * cosTheta, 0.0f));
+	const float phi = 2.0f * glm::pi<float>() * u.y;
+
+	const glm::vec3 w = toCenter / distance;
+	const glm::vec3 t = glm::normalize(glm::abs(w.x) > 0.9f ? glm::cross(w, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::cross(w, glm::vec3(1.0f, 0.0f, 0.0f)));
+	const glm::vec3 b = glm::cross(w, t);
+	const glm::vec3 direction = (t * glm::cos(phi) + b * glm::sin(phi)) * sinTheta + w * cosTheta;
+
+	const float cosSurface = glm::dot(payload.WorldNormal, direction);
+	if (cosSurface <= 0.0f)
+		return false;
+
+	// Distance to the near side of the sphere along the sampled direction, the shadow ray stops just short of it
+	const float lightDistance = distance * cosTheta - glm::sqrt(glm::max(radiusSquared - distanceSquared * sinTheta * sinTheta, 0.0f));
+	shadowRay = Ray{ payload.WorldPosition + payload.WorldNormal * Utils::ShadowRayOffset, direction };
+	shadowDistance = lightDistance * 0.999f;
+
+	// Lambertian: the BSDF is albedo / pi, the caller's throughput already holds the albedo
+	const float lightPdf = emitter.SelectionPdf / (2.0f * glm::pi<float>() * oneMinusCosMax);
+	const float bsdfPdf = cosSurface * glm::one_over_pi<float>();
+	contribution = emitter.Radiance * (bsdfPdf / lightPdf * Utils::PowerHeuristic(lightPdf, bsdfPdf));
+	return true;
+}
+
+float Renderer::GetEmitterPdf(uint32_t emitterIndex, const glm::vec3& position) const
+{
+	const Emitter& emitter = m_CompiledScene.GetEmitters()[emitterIndex];
+	const glm::vec3 toCenter = emitter.Center - position;
+	const float distanceSquared = glm::dot(toCenter, toCenter);
+	const float radiusSquared = emitter.Radius * emitter.Radius;
+	if (distanceSquared <= radiusSquared * 1.0001f)
+		return 0.0f;
+
+	return emitter.SelectionPdf / (2.0f * glm::pi<float>() * Utils::ConeOneMinusCos(radiusSquared / distanceSquared));
+}
+
+Sampler Renderer::CreatePixelSampler(uint32_t x, uint32_t y) const
+{
+	// Every accumulated frame is the next sample of each pixel
+	return Sampler(m_Settings.Sampler, x, y, m_FrameIndex - 1);
+}
+
+Ray Renderer::GenerateCameraRay(uint32_t x, uint32_t y, Sampler& sampler) const
+{
+	// Both are drawn even when unused, so the dimensions of the bounces don't depend on the camera settings
+	glm::vec2 jitter = sampler.Next2D();
+	if (!m_Settings.Jitter)
+		jitter = glm::vec2(0.5f);
+
+	glm::vec2 lensSample = sampler.Next2D();
+	if (!m_ActiveCamera->HasDepthOfField())
+		lensSample = glm::vec2(0.5f);
+
+	return m_ActiveCamera->GenerateRay((float)x + jitter.x, (float)y + jitter.y, lensSample);
+}
+
+Renderer::HitPayload Renderer::TraceRay(const Ray& ray)
+{
+	HitRecord hit;
+	if (!m_CompiledScene.Intersect(ray, hit))
+		return Miss(ray);
+
+	return ClosestHit(ray, hit);
+}
+
+Renderer::HitPayload Renderer::Miss(const Ray& ray)
+{
+	Renderer::HitPayload payload;
+	payload.HitDistance = -1.0f;
+	return payload;
+}
+
+Renderer::HitPayload Renderer::ClosestHit(const Ray& ray, const HitRecord& hit)
+{
+	Renderer::HitPayload payload;
+	payload.HitDistance = hit.Distance;
+	payload.MaterialIndex = m_CompiledScene.GetMaterialIndex(hit);
+	payload.EmitterIndex = m_CompiledScene.GetEmitterIndex(hit);
+	payload.WorldPosition = ray.Origin + ray.Direction * hit.Distance;
+	payload.WorldNormal = m_CompiledScene.GetNormal(ray, hit);
+
+	return payload;
+}
\ No newline at end of file
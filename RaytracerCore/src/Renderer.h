@@ -0,0 +1,236 @@
+#pragma once
+#include <memory>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Camera.h"
+#include "Ray.h"
+#include "Scene.h"
+#include "CompiledScene.h"
+#include "RayPacket.h"
+#include "TileScheduler.h"
+#include "Denoiser.h"
+#include "PathQueue.h"
+#include "Tonemapper.h"
+#include "Framebuffer.h"
+#include "Sampler.h"
+#include "Stats.h"
+
+class Renderer
+{
+public:
+	struct Settings
+	{
+		bool Accumulate = true;
+		// Trace primary rays as coherent PacketSize x PacketSize blocks, bounces are always traced one ray at a time
+		bool PacketTracing = false;
+		uint32_t PacketSize = 8;
+		// Render threads, 0 uses every hardware thread
+		uint32_t ThreadCount = 0;
+		uint32_t TileSize = 32;
+		// Jitter primary rays inside their pixel, which anti-aliases edges as samples accumulate
+		bool Jitter = true;
+		// Where the random numbers of every sample come from, see Sampler. The low discrepancy sequences reach a
+		// given noise level in fewer samples than independent random numbers.
+		SamplerType Sampler = SamplerType::Sobol;
+		// Sample emissive spheres directly at every bounce with a shadow ray, combined with the bounces that hit
+		// them by multiple importance sampling. Small lights converge far faster than when found by chance.
+		bool NextEventEstimation = true;
+
+		// Trace each tile as a wavefront: all of its paths are extended, shaded and connected to the lights one
+		// stage at a time, with the paths that ended compacted out between bounces. Paths past
+		// RussianRouletteDepth bounces are terminated at random by their throughput, in this mode only.
+		bool Wavefront = false;
+		bool RussianRoulette = true;
+		uint32_t RussianRouletteDepth = 3;
+
+		// Stop sampling pixels once the standard error of their displayed luminance drops below NoiseThreshold,
+		// so later frames only trace the pixels that are still noisy. Needs Accumulate.
+		bool AdaptiveSampling = false;
+		float NoiseThreshold = 0.01f;
+		uint32_t MinSamples = 16; // Samples before a pixel may converge, so a few lucky dark samples can't stop it
+		bool ShowActivePixels = false; // Tint the pixels that are still being sampled
+
+		// While the camera moves, trace one sample per block of pixels with fewer bounces instead of full frames.
+		// The block size adapts so a frame fits FrameBudgetMs, and halves every frame once the camera stops
+		// until accumulation resumes at full resolution.
+		bool ProgressivePreview = false;
+		float FrameBudgetMs = 33.0f;
+		uint32_t PreviewBounces = 2;
+
+		// Filter the accumulated image with the edge-aware denoiser before display, see GetDenoiser for its settings
+		bool Denoise = false;
+
+		// Resolve the accumulation into the display image at the end of every frame. Batch renders that only
+		// read the accumulation turn this off and call Resolve themselves if they want the image.
+		bool ResolveEveryFrame = true;
+
+		// Keep the accumulated image when the camera moves: every pixel picks up the history from where its first
+		// hit was on screen last frame, unless the depth or normal there doesn't match, which means the surface was
+		// hidden or is a different one. History is capped at MaxHistorySamples so the blur of resampling it fades
+		// as new samples come in. Needs Accumulate and replaces the progressive preview.
+		bool TemporalReprojection = false;
+		uint32_t MaxHistorySamples = 64;
+		float DepthTolerance = 0.05f; // Relative to the distance from the camera
+		float NormalTolerance = 0.9f; // Minimum cosine between the normals
+	};
+
+	// Depth recorded for samples whose camera ray hits nothing
+	static constexpr float MissDepth = 1e4f;
+
+	Renderer() = default;
+	void Render(const Scene& scene, const Camera& camera);
+	void OnResize(uint32_t width, uint32_t height);
+
+	// Display image, one RGBA8 pixel per uint32_t with row 0 at the bottom. Written by Resolve, or directly by the
+	// tiles of a preview frame.
+	const uint32_t* GetImageData() const { return m_ImageData.Data(); }
+	// Tone maps the current accumulation into the display image, see GetTonemapper for the exposure and curve
+	void Resolve();
+	Tonemapper& GetTonemapper() { return m_Tonemapper; }
+	// Time of the last frame's Resolve, 0 if it had none. Denoised frames are resolved by Denoise instead.
+	float GetResolveMs() const { return m_ResolveMs; }
+	// Sum of all accumulated samples in linear colour, divide by the pixel's sample count for its value
+	const glm::vec3* GetAccumulationData() const { return m_Accumulation.Color.Data(); }
+	// Samples accumulated per pixel, the same for every pixel unless adaptive sampling is on
+	const uint32_t* GetSampleCountData() const { return m_Accumulation.SampleCount.Data(); }
+	// Sums of the first-hit albedo, normal and hit distance of every sample (AOVs), divide by the sample count
+	const glm::vec3* GetAlbedoData() const { return m_Accumulation.Albedo.Data(); }
+	const glm::vec3* GetNormalData() const { return m_Accumulation.Normal.Data(); }
+	const float* GetDepthData() const { return m_Accumulation.Depth.Data(); }
+	// Denoised linear colour of the last frame, only updated while Settings::Denoise is on
+	const glm::vec3* GetDenoisedData() const { return m_DenoisedData.Data(); }
+	Denoiser& GetDenoiser() { return m_Denoiser; }
+	// Filters the current accumulation into the denoised and display images. Render calls this instead of Resolve
+	// while Settings::Denoise is on, offline renders can call it once after the last sample instead.
+	void Denoise();
+	float GetDenoiseMs() const { return m_DenoiseMs; }
+	// Pixels that were sampled in the last frame
+	uint32_t GetActivePixelCount() const { return m_ActivePixelCount; }
+	// Width and height in pixels of the blocks the last frame traced one sample for, 1 is full resolution
+	uint32_t GetPreviewScale() const { return m_FrameScale; }
+	// Pixels of the last frame that kept history from before the camera moved, 0 if it didn't move
+	uint32_t GetReprojectedPixelCount() const { return m_ReprojectedPixelCount; }
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+	void ResetFrameIndex() { m_FrameIndex = 1; }
+	Settings& getSettings() { return m_Settings; }
+	uint32_t& getBounces() { return bounces; }
+	const uint32_t& getFrameIndex() { return m_FrameIndex; }
+	const CompiledScene& GetCompiledScene() const { return m_CompiledScene; }
+	float GetMraysPerSecond() const { return m_MraysPerSecond; }
+	const std::vector<WorkerStats>& GetThreadStats() const { return m_ThreadStats; }
+	const std::vector<uint64_t>& GetThreadRayCounts() const { return m_ThreadRayCounts; }
+	// Timings and trace counters of the last Render call
+	const FrameStats& GetFrameStats() const { return m_FrameStats; }
+private:
+	struct HitPayload
+	{
+		float HitDistance;
+		glm::vec3 WorldPosition;
+		glm::vec3 WorldNormal;
+		uint32_t MaterialIndex;
+		uint32_t EmitterIndex; // CompiledScene::NoEmitter unless an emitter of the light list was hit
+	};
+	// First-hit surface of a sample, accumulated into the AOV buffers
+	struct AOVSample
+	{
+		glm::vec3 Albedo{ 0.0f };
+		glm::vec3 Normal{ 0.0f };
+		float Depth = MissDepth;
+		glm::vec3 Position{ 0.0f }; // Of the hit, or MissDepth along the ray, only used for reprojection
+	};
+	// Per-thread state of a wavefront tile: the path queues of the current and next bounce, the shadow rays of
+	// the bounce, and the radiance and first-hit AOVs gathered for each pixel of the tile
+	struct WavefrontState
+	{
+		PathQueue Paths, NextPaths;
+		ShadowQueue ShadowRays;
+		std::vector<HitRecord> Hits; // Closest hit of every path in Paths
+		std::vector<glm::vec3> Radiance;
+		std::vector<AOVSample> AOVs;
+		std::vector<uint32_t> ActivePixels; // Pixels of the tile that got a path, in tile order
+	};
+	// primaryHit lets the caller supply the first intersection when it was already found by a packet
+	glm::vec4 RayGen(uint32_t x, uint32_t y, uint32_t& rayCount, const HitPayload* primaryHit = nullptr, AOVSample* aov = nullptr);
+	// Random numbers of the current frame's sample of a pixel
+	Sampler CreatePixelSampler(uint32_t x, uint32_t y) const;
+	// Camera ray for a pixel with its jitter and lens position drawn from the sampler
+	Ray GenerateCameraRay(uint32_t x, uint32_t y, Sampler& sampler) const;
+	// Light reflected towards the ray from one sampled emitter, weighted for MIS. Leaves out the surface albedo,
+	// which the caller multiplies in with its throughput.
+	glm::vec3 SampleDirectLight(const HitPayload& payload, Sampler& sampler, uint32_t& rayCount);
+	// The sampling half of SampleDirectLight: returns false if no light can arrive, otherwise the shadow ray and
+	// the light it carries when nothing is hit before shadowDistance
+	bool SampleEmitter(const HitPayload& payload, Sampler& sampler, Ray& shadowRay, float& shadowDistance, glm::vec3& contribution) const;
+	// Solid angle pdf with which SampleDirectLight picks a direction towards the emitter from position
+	float GetEmitterPdf(uint32_t emitterIndex, const glm::vec3& position) const;
+	void RenderTile(const Tile& tile, uint32_t threadIndex);
+	void RenderPacketTile(const Tile& tile, uint32_t threadIndex);
+	// Wavefront stages, see Settings::Wavefront
+	void RenderWavefrontTile(const Tile& tile, uint32_t threadIndex);
+	void GeneratePaths(const Tile& tile, WavefrontState& state);
+	void ExtendPaths(WavefrontState& state, uint32_t& rayCount);
+	void ShadePaths(WavefrontState& state, uint32_t bounce);
+	void ConnectShadowRays(WavefrontState& state, uint32_t& rayCount);
+	// One sample per m_FrameScale x m_FrameScale block, written straight to the display without accumulating
+	void RenderPreviewTile(const Tile& tile, uint32_t threadIndex);
+	// Block size for this frame, updates the preview state from camera motion or scene edits and the last frame time
+	uint32_t ChoosePreviewScale(bool moving);
+	// False once adaptive sampling considers the pixel converged
+	bool IsPixelActive(uint32_t x, uint32_t y) const;
+	void AccumulatePixel(uint32_t x, uint32_t y, const glm::vec4& col, const AOVSample& aov);
+	// Fills a pixel's cleared buffers with the history its sample reprojects to, returns false if it has none
+	bool ReprojectPixel(uint32_t x, uint32_t y, const AOVSample& aov);
+	HitPayload TraceRay(const Ray& ray);
+	HitPayload ClosestHit(const Ray& ray, const HitRecord& hit);
+	HitPayload Miss(const Ray& ray);
+private:
+	Settings m_Settings;
+	uint32_t m_Width = 0, m_Height = 0;
+	AlignedBuffer<uint32_t> m_ImageData;
+	Framebuffer m_Accumulation;
+	AlignedBuffer<glm::vec3> m_DenoisedData;
+
+	// The accumulation from before the camera moved, swapped with the current one on every move
+	Framebuffer m_History;
+	glm::mat4 m_HistoryViewProjection{ 1.0f };
+	glm::vec3 m_HistoryPosition{ 0.0f };
+	bool m_ReprojectHistory = false; // The current frame picks up history instead of starting over
+
+	const Scene* m_ActiveScene = nullptr;
+	const Camera* m_ActiveCamera = nullptr;
+	CompiledScene m_CompiledScene;
+
+	uint32_t m_FrameIndex = 1;
+	uint32_t bounces = 32;
+	uint32_t m_FrameBounces = 32; // Bounces of the frame being rendered, fewer during a preview
+
+	// Camera of the last frame, to detect motion
+	glm::mat4 m_LastView{ 0.0f }, m_LastProjection{ 0.0f };
+	glm::vec3 m_LastPosition{ 0.0f };
+
+	// Progressive preview state
+	uint32_t m_MotionScale = 2; // Block size used while moving, adapted to the frame budget
+	uint32_t m_RefineScale = 1; // Block size of the next refinement frame after the camera stopped
+	uint32_t m_FrameScale = 1;
+	float m_LastFrameMs = 0.0f;
+
+	TileScheduler m_Scheduler;
+	std::vector<uint64_t> m_ThreadRayCounts;
+	std::vector<uint32_t> m_ThreadActivePixels;
+	std::vector<uint32_t> m_ThreadReprojectedPixels;
+	std::vector<WavefrontState> m_ThreadWavefronts;
+	std::vector<WorkerStats> m_ThreadStats; // Of the render pass, the denoiser reuses the scheduler afterwards
+	uint32_t m_ActivePixelCount = 0;
+	uint32_t m_ReprojectedPixelCount = 0;
+	float m_MraysPerSecond = 0.0f;
+	FrameStats m_FrameStats;
+
+	Denoiser m_Denoiser;
+	float m_DenoiseMs = 0.0f;
+
+	Tonemapper m_Tonemapper;
+	float m_ResolveMs = 0.0f;
+};
+
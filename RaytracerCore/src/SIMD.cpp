@@ -0,0 +1,58 @@
+#include "SIMD.h"
+
+#if RT_SIMD_X64 && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace Utils {
+	static SIMDLevel DetectSIMDLevel()
+	{
+#if !RT_SIMD_X64
+		return SIMDLevel::Scalar;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+
+		// The OS has to save the YMM registers on context switches as well
+		bool osSupportsAVX = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+		if (avx2 && fma && osSupportsAVX)
+			return SIMDLevel::AVX2;
+		return SIMDLevel::SSE;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			return SIMDLevel::AVX2;
+		return SIMDLevel::SSE;
+#endif
+	}
+}
+
+SIMDLevel GetSupportedSIMDLevel()
+{
+	static const SIMDLevel level = Utils::DetectSIMDLevel();
+	return level;
+}
+
+const char* GetSIMDLevelName(SIMDLevel level)
+{
+	switch (level)
+	{
+	case SIMDLevel::Scalar: return "Scalar";
+	case SIMDLevel::SSE:    return "SSE (4-wide)";
+	case SIMDLevel::AVX2:   return "AVX2 (8-wide)";
+	}
+	return "Unknown";
+}
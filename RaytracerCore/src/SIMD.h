@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define RT_SIMD_X64 1
+	#include <immintrin.h>
+#else
+	#define RT_SIMD_X64 0
+#endif
+
+// MSVC lets any function use AVX intrinsics, GCC and Clang need the target enabled per function so the rest of
+// the binary still runs on machines without AVX2
+#if RT_SIMD_X64 && (defined(__GNUC__) || defined(__clang__))
+	#define RT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+	#define RT_TARGET_AVX2
+#endif
+
+enum class SIMDLevel
+{
+	Scalar = 0, SSE = 1, AVX2 = 2
+};
+
+// Widest instruction set supported by both the CPU and the OS, detected once
+SIMDLevel GetSupportedSIMDLevel();
+const char* GetSIMDLevelName(SIMDLevel level);
+
+inline uint32_t GetSIMDWidth(SIMDLevel level)
+{
+	switch (level)
+	{
+	case SIMDLevel::SSE:  return 4;
+	case SIMDLevel::AVX2: return 8;
+	default:              return 1;
+	}
+}
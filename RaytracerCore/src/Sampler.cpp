@@ -0,0 +1,282 @@
+#include "Sampler.h"
+
+#include <vector>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace Utils {
+	static uint32_t PCG_Hash(uint32_t input)
+	{
+		uint32_t state = input * 747796405u + 2891336453u;
+		uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+
+	static uint32_t HashCombine(uint32_t seed, uint32_t value)
+	{
+		return PCG_Hash(seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2)));
+	}
+
+	// The top 24 bits as a float in [0, 1), all of them are exact so the result never rounds up to 1
+	static float ToUnitFloat(uint32_t bits)
+	{
+		return (float)(bits >> 8) * (1.0f / 16777216.0f);
+	}
+
+	static uint32_t ReverseBits(uint32_t x)
+	{
+		x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+		x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+		x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+		x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+		return (x >> 16) | (x << 16);
+	}
+
+	// Hash in which every bit only depends on the bits below it (Laine and Karras). On bit reversed values that
+	// makes it an Owen scramble: each bit is flipped by a hash of the bits above it, which keeps the
+	// stratification of the points while decorrelating sequences with different seeds.
+	static uint32_t NestedUniformScramble(uint32_t x, uint32_t seed)
+	{
+		x = ReverseBits(x);
+		x += seed;
+		x ^= x * 0x6c50b47cu;
+		x ^= x * 0xb82f1e52u;
+		x ^= x * 0xc7afe638u;
+		x ^= x * 0x8d22f6e6u;
+		return ReverseBits(x);
+	}
+
+	// First two dimensions of the Sobol sequence, together a (0, 2)-sequence: every power of two prefix is
+	// stratified over all elementary intervals
+	static uint32_t Sobol0(uint32_t index) { return ReverseBits(index); }
+
+	static uint32_t Sobol1(uint32_t index)
+	{
+		uint32_t result = 0;
+		for (uint32_t direction = 1u << 31; index; index >>= 1, direction ^= direction >> 1)
+		{
+			if (index & 1)
+				result ^= direction;
+		}
+		return result;
+	}
+
+	// Fractional parts of the golden ratio and of the R2 sequence's generators, as 0.32 fixed point. Stepping by
+	// them gives the best spread additive sequences in one and two dimensions.
+	static constexpr uint32_t GoldenRatio = 2654435769u;
+	static constexpr uint32_t R2X = 3242174889u;
+	static constexpr uint32_t R2Y = 2447445414u;
+
+	// Tileable blue noise mask made with void and cluster (Ulichney 1993): pixels are ranked by repeatedly taking the
+	// tightest cluster out of a pattern or putting a pixel into its largest void, so every threshold of the ranks
+	// is an evenly spread set of pixels. Ranks are stored as 0.32 fixed point.
+	class BlueNoiseMask
+	{
+	public:
+		static constexpr uint32_t Size = 64;
+
+		BlueNoiseMask() : m_Values(Size * Size)
+		{
+			constexpr uint32_t pixelCount = Size * Size;
+			constexpr float sigma = 1.5f;
+
+			// Gaussian falloff by wrapped offset, so the mask tiles without seams
+			std::vector<float> falloff(pixelCount);
+			for (uint32_t y = 0; y < Size; y++)
+			{
+				for (uint32_t x = 0; x < Size; x++)
+				{
+					const float dx = (float)std::min(x, Size - x), dy = (float)std::min(y, Size - y);
+					falloff[x + y * Size] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+				}
+			}
+
+			std::vector<uint8_t> pattern(pixelCount, 0);
+			std::vector<float> energy(pixelCount, 0.0f);
+			auto toggle = [&](uint32_t pixel, bool set)
+			{
+				pattern[pixel] = set;
+				const uint32_t px = pixel % Size, py = pixel / Size;
+				const float sign = set ? 1.0f : -1.0f;
+				for (uint32_t y = 0; y < Size; y++)
+					for (uint32_t x = 0; x < Size; x++)
+						energy[x + y * Size] += sign * falloff[((x - px) & (Size - 1)) + ((y - py) & (Size - 1)) * Size];
+			};
+			// Densest set pixel or emptiest unset one
+			auto find = [&](bool set)
+			{
+				uint32_t best = 0;
+				float bestEnergy = set ? -1.0f : 1e30f;
+				for (uint32_t pixel = 0; pixel < pixelCount; pixel++)
+				{
+					if (pattern[pixel] == set && (set ? energy[pixel] > bestEnergy : energy[pixel] < bestEnergy))
+					{
+						best = pixel;
+						bestEnergy = energy[pixel];
+					}
+				}
+				return best;
+			};
+
+			// A tenth of the pixels at random, then spread out by moving the tightest cluster into the largest
+			// void until that puts it back where it was
+			uint32_t seed = 1;
+			uint32_t setCount = 0;
+			for (uint32_t pixel = 0; pixel < pixelCount; pixel++)
+			{
+				seed = PCG_Hash(seed);
+				if (seed % 10 == 0)
+				{
+					toggle(pixel, true);
+					setCount++;
+				}
+			}
+			for (;;)
+			{
+				const uint32_t cluster = find(true);
+				toggle(cluster, false);
+				const uint32_t gap = find(false);
+				toggle(gap, true);
+				if (gap == cluster)
+					break;
+			}
+			const std::vector<uint8_t> initialPattern = pattern;
+			const std::vector<float> initialEnergy = energy;
+
+			// The initial pixels rank below setCount, the most clustered of them highest
+			std::vector<uint32_t> ranks(pixelCount);
+			for (uint32_t rank = setCount; rank-- > 0;)
+			{
+				const uint32_t cluster = find(true);
+				toggle(cluster, false);
+				ranks[cluster] = rank;
+			}
+
+			// The rest rank in the order they fill the voids
+			pattern = initialPattern;
+			energy = initialEnergy;
+			for (uint32_t rank = setCount; rank < pixelCount; rank++)
+			{
+				const uint32_t gap = find(false);
+				toggle(gap, true);
+				ranks[gap] = rank;
+			}
+
+			// Centre of each rank's interval, 4096 ranks are 12 bits
+			for (uint32_t pixel = 0; pixel < pixelCount; pixel++)
+				m_Values[pixel] = (ranks[pixel] * 2 + 1) << 19;
+		}
+
+		// Value at a pixel of the mask, shifted by a hash so every dimension reads a different part of it
+		uint32_t Get(uint32_t x, uint32_t y, uint32_t hash) const
+		{
+			return m_Values[((x + hash) & (Size - 1)) + ((y + (hash >> 6)) & (Size - 1)) * Size];
+		}
+	private:
+		std::vector<uint32_t> m_Values;
+	};
+
+	static const BlueNoiseMask& GetBlueNoiseMask()
+	{
+		// Built on first use, which takes some tens of milliseconds
+		static const BlueNoiseMask mask;
+		return mask;
+	}
+}
+
+const char* GetSamplerTypeName(SamplerType type)
+{
+	switch (type)
+	{
+	case SamplerType::Random:    return "Random";
+	case SamplerType::Sobol:     return "Sobol";
+	case SamplerType::BlueNoise: return "Blue Noise";
+	}
+	return "Unknown";
+}
+
+Sampler::Sampler(SamplerType type, uint32_t x, uint32_t y, uint32_t sampleIndex) :
+	m_X(x), m_Y(y), m_SampleIndex(sampleIndex), m_Type(type)
+{
+	m_Seed = Utils::HashCombine(Utils::PCG_Hash(x), y);
+	if (type == SamplerType::Random)
+		m_Seed = Utils::HashCombine(m_Seed, sampleIndex);
+	else if (type == SamplerType::BlueNoise)
+		Utils::GetBlueNoiseMask();
+}
+
+float Sampler::Next1D()
+{
+	const uint32_t dimension = m_Dimension++;
+	switch (m_Type)
+	{
+	case SamplerType::Random:
+		break;
+	case SamplerType::Sobol:
+	{
+		const uint32_t seed = Utils::HashCombine(m_Seed, dimension);
+		const uint32_t index = Utils::NestedUniformScramble(m_SampleIndex, seed);
+		return Utils::ToUnitFloat(Utils::NestedUniformScramble(Utils::Sobol0(index), Utils::PCG_Hash(seed)));
+	}
+	case SamplerType::BlueNoise:
+		return Utils::ToUnitFloat(Utils::GetBlueNoiseMask().Get(m_X, m_Y, Utils::PCG_Hash(dimension)) + m_SampleIndex * Utils::GoldenRatio);
+	}
+	return Utils::ToUnitFloat(Utils::HashCombine(m_Seed, dimension));
+}
+
+glm::vec2 Sampler::Next2D()
+{
+	const uint32_t dimension = m_Dimension;
+	m_Dimension += 2;
+	switch (m_Type)
+	{
+	case SamplerType::Random:
+		break;
+	case SamplerType::Sobol:
+	{
+		// Both dimensions of the pair are indexed by the same shuffled index, which keeps them a (0, 2)-sequence
+		const uint32_t seed = Utils::HashCombine(m_Seed, dimension);
+		const uint32_t index = Utils::NestedUniformScramble(m_SampleIndex, seed);
+		return glm::vec2(Utils::ToUnitFloat(Utils::NestedUniformScramble(Utils::Sobol0(index), Utils::HashCombine(seed, 0))),
+			Utils::ToUnitFloat(Utils::NestedUniformScramble(Utils::Sobol1(index), Utils::HashCombine(seed, 1))));
+	}
+	case SamplerType::BlueNoise:
+	{
+		const Utils::BlueNoiseMask& mask = Utils::GetBlueNoiseMask();
+		return glm::vec2(Utils::ToUnitFloat(mask.Get(m_X, m_Y, Utils::PCG_Hash(dimension)) + m_SampleIndex * Utils::R2X),
+			Utils::ToUnitFloat(mask.Get(m_X, m_Y, Utils::PCG_Hash(dimension + 1)) + m_SampleIndex * Utils::R2Y));
+	}
+	}
+	return glm::vec2(Utils::ToUnitFloat(Utils::HashCombine(m_Seed, dimension)), Utils::ToUnitFloat(Utils::HashCombine(m_Seed, dimension + 1)));
+}
+
+glm::vec3 SampleCosineHemisphere(const glm::vec3& normal, const glm::vec2& u)
+{
+	// Concentric map of the square onto the unit disk (Shirley and Chiu), then up onto the hemisphere (Malley)
+	const glm::vec2 square = u * 2.0f - 1.0f;
+	glm::vec2 disk(0.0f);
+	if (square.x != 0.0f || square.y != 0.0f)
+	{
+		float radius, phi;
+		if (glm::abs(square.x) > glm::abs(square.y))
+		{
+			radius = square.x;
+			phi = glm::quarter_pi<float>() * (square.y / square.x);
+		}
+		else
+		{
+			radius = square.y;
+			phi = glm::half_pi<float>() - glm::quarter_pi<float>() * (square.x / square.y);
+		}
+		disk = glm::vec2(radius * std::cos(phi), radius * std::sin(phi));
+	}
+	const float z = glm::sqrt(glm::max(1.0f - glm::dot(disk, disk), 0.0f));
+
+	// Tangent frame without branches or normalization (Duff et al. 2017)
+	const float sign = std::copysign(1.0f, normal.z);
+	const float a = -1.0f / (sign + normal.z);
+	const float b = normal.x * normal.y * a;
+	const glm::vec3 tangent(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+	const glm::vec3 bitangent(b, sign + normal.y * normal.y * a, -normal.y);
+	return tangent * disk.x + bitangent * disk.y + normal * z;
+}
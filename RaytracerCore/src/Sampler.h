@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+enum class SamplerType
+{
+	Random = 0, Sobol = 1, BlueNoise = 2
+};
+
+const char* GetSamplerTypeName(SamplerType type);
+
+// The random numbers of one sample of one pixel, drawn in a fixed order: every call takes the next dimension, so
+// a path asks for its values in the same order every frame and sample index i of the pixel gets point i of the
+// sequence. Values are in [0, 1).
+//
+// Random hashes pixel, sample and dimension into an independent value. Sobol draws 2D points of an Owen scrambled
+// Sobol sequence, each pair of dimensions with its own shuffle of the sample index and its own scramble
+// ("padding"), so dimensions stay uncorrelated while every pair is stratified over the samples of a pixel.
+// BlueNoise gives each pixel its own offset from a tiled blue noise mask and steps it along a low discrepancy
+// sequence, so neighbouring pixels get different values and the error of low sample counts is spread out as fine,
+// even noise instead of clumps.
+class Sampler
+{
+public:
+	Sampler() = default;
+	Sampler(SamplerType type, uint32_t x, uint32_t y, uint32_t sampleIndex);
+
+	float Next1D();
+	glm::vec2 Next2D();
+private:
+	uint32_t m_X = 0, m_Y = 0;
+	uint32_t m_SampleIndex = 0;
+	uint32_t m_Seed = 0; // Of the pixel, for the hashes and scrambles
+	uint32_t m_Dimension = 0;
+	SamplerType m_Type = SamplerType::Random;
+};
+
+// Unit vector around normal with pdf cos(theta) / pi, from a 2D sample. The concentric disk mapping keeps the
+// stratification of the sample, which the rejection or sphere based methods lose.
+glm::vec3 SampleCosineHemisphere(const glm::vec3& normal, const glm::vec2& u);
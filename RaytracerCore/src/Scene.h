@@ -0,0 +1,247 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <cmath>
+
+#include "Ray.h"
+#include "BVH.h"
+#include "Primitives.h"
+#include "IntersectKernels.h"
+#include "Stats.h"
+#include "Mesh.h"
+#include "MeshGeometry.h"
+#include "Transform.h"
+
+struct IntersectResult
+{
+	float HitDistance;
+	glm::vec3 HitSurfaceNormal;
+};
+
+struct Material
+{
+	glm::vec3 Albedo{ 1.0f, 1.0f, 1.0f };
+	float Roughness = 1.0f;
+	float Metallic = 0.0f;
+
+	glm::vec3 EmissionColor{ 0.0f };
+	float EmissionPower = 0.0f;
+
+	glm::vec3 getEmission() const { return EmissionColor * EmissionPower; }
+};
+
+enum class ObjectType
+{
+	Sphere, Plane, Model
+};
+
+class SceneObject
+{
+public:
+	SceneObject(){}
+	SceneObject(glm::vec3 pos, int mat) :
+		Position(pos),MaterialIndex(mat){}
+	virtual ~SceneObject() = default;
+	virtual ObjectType GetType() const = 0;
+	virtual IntersectResult RayIntersect(const Ray& ray) const = 0;
+	virtual AABB GetBounds() const = 0;
+	// Unbounded objects can't be placed in the scene BVH and are tested against every ray instead
+	virtual bool IsBounded() const { return true; }
+
+public:
+	glm::vec3 Position{ 0.0f };
+	int MaterialIndex = 0;
+};
+
+class Sphere : public SceneObject
+{
+public:
+	Sphere() {};
+	Sphere(glm::vec3 pos, float rad, int mat) :
+		SceneObject{pos, mat}, Radius(rad) {}
+
+	ObjectType GetType() const override { return ObjectType::Sphere; }
+
+	IntersectResult RayIntersect(const Ray& ray) const override
+	{
+		float t = IntersectSphere(ray, Position, Radius);
+		if (t < 0.0f)
+			return IntersectResult{ -1.0f };
+
+		return IntersectResult{ t,  glm::normalize(ray.Origin - Position + ray.Direction * t) };
+	}
+
+	AABB GetBounds() const override
+	{
+		glm::vec3 extent(glm::abs(Radius));
+		return AABB{ Position - extent, Position + extent };
+	}
+
+public:
+	float Radius = 1.0f;
+};
+
+class Plane : public SceneObject
+{
+public:
+	Plane() {};
+	Plane(glm::vec3 pos, glm::vec3 normal, int mat) :
+		SceneObject{ pos, mat }, Normal(glm::normalize(normal)) {}
+
+	ObjectType GetType() const override { return ObjectType::Plane; }
+
+	IntersectResult RayIntersect(const Ray& ray) const override
+	{
+		float t = IntersectPlane(ray, Position, Normal);
+		if (t < 0.0f)
+			return IntersectResult{ -1.0f };
+
+		return IntersectResult{ t, Normal };
+	}
+
+	AABB GetBounds() const override { return AABB{}; }
+	bool IsBounded() const override { return false; }
+
+public:
+	glm::vec3 Normal{ 0.0f, 1.0f, 0.0f };
+};
+
+class Model : public SceneObject {
+public:
+	Model(std::shared_ptr<const Mesh> mesh, glm::vec3 pos, int mat) :
+		Model(std::make_shared<const MeshGeometry>(std::move(mesh)), pos, mat) {}
+	// Another instance of geometry that is already built, sharing its mesh, BVH and triangles
+	Model(std::shared_ptr<const MeshGeometry> geometry, glm::vec3 pos, int mat) :
+		SceneObject{ pos, mat }, m_Geometry(std::move(geometry)) {}
+
+	ObjectType GetType() const override { return ObjectType::Model; }
+
+	// Not safe to call from several threads at once right after the transform was edited, the first call refreshes
+	// the cached inverse. The renderer traces the compiled scene instead.
+	IntersectResult RayIntersect(const Ray& ray) const override {
+		const AffineTransform& worldToObject = GetWorldToObject();
+		float closestHit = FLT_MAX;
+		uint32_t closestTriangle = 0;
+		m_Geometry->Intersect(worldToObject.TransformRay(ray), closestHit, closestTriangle);
+		if (closestHit == FLT_MAX)
+			return IntersectResult{ -1.0f };
+
+		// Normals go back to the scene by the inverse transpose, which keeps them perpendicular under non-uniform scale
+		glm::vec3 normal = glm::normalize(m_NormalToWorld * m_Geometry->GetNormal(closestTriangle));
+		return IntersectResult{ closestHit, glm::dot(normal, ray.Direction) > 0.0f ? -normal : normal };
+	}
+
+	AABB GetBounds() const override { return GetObjectToWorld().TransformBounds(m_Geometry->GetBounds()); }
+
+	// Maps the mesh into the scene: scaled, then rotated by Rotation, then moved to Position
+	AffineTransform GetObjectToWorld() const { return AffineTransform::FromTRS(Position, Rotation, Scale); }
+	// Inverse of GetObjectToWorld, kept until Position, Rotation or Scale change rather than rebuilt for every ray
+	const AffineTransform& GetWorldToObject() const
+	{
+		if (Position != m_CachedPosition || Rotation != m_CachedRotation || Scale != m_CachedScale)
+		{
+			m_WorldToObject = GetObjectToWorld().Inverse();
+			m_NormalToWorld = glm::transpose(m_WorldToObject.Linear);
+			m_CachedPosition = Position;
+			m_CachedRotation = Rotation;
+			m_CachedScale = Scale;
+		}
+		return m_WorldToObject;
+	}
+
+	size_t GetTriangleCount() const { return m_Geometry->GetTriangleCount(); }
+	const BVHStats& GetBVHStats() const { return m_Geometry->GetBVHStats(); }
+	const Mesh& GetMesh() const { return m_Geometry->GetMesh(); }
+	const MeshGeometry& GetGeometry() const { return *m_Geometry; }
+	const std::shared_ptr<const MeshGeometry>& GetSharedGeometry() const { return m_Geometry; }
+
+public:
+	// A zero or non-finite component would make the transform singular, so every component must stay away from zero
+	static bool IsValidScale(const glm::vec3& scale)
+	{
+		for (int i = 0; i < 3; i++)
+			if (scale[i] == 0.0f || !std::isfinite(scale[i]))
+				return false;
+		return true;
+	}
+
+public:
+	// Euler angles in degrees, applied about x, then y, then z
+	glm::vec3 Rotation{ 0.0f };
+	// Negative components mirror the mesh, none may be zero (see IsValidScale)
+	glm::vec3 Scale{ 1.0f };
+
+private:
+	// Built once per mesh and shared between instances, each Model only adds its transform and material
+	std::shared_ptr<const MeshGeometry> m_Geometry;
+
+	// The transform GetWorldToObject was last computed for, the initial values are its identity result
+	mutable glm::vec3 m_CachedPosition{ 0.0f }, m_CachedRotation{ 0.0f }, m_CachedScale{ 1.0f };
+	mutable AffineTransform m_WorldToObject;
+	mutable glm::mat3 m_NormalToWorld{ 1.0f };
+};
+
+// Versions come from one counter shared by every scene, so a scene that replaces another never repeats the
+// versions its predecessor was compiled at
+inline uint64_t NextSceneVersion()
+{
+	static std::atomic<uint64_t> version{ 0 };
+	return ++version;
+}
+
+// Objects and materials can be read directly, but edits to a scene that is being rendered go through the functions
+// below so the renderer can tell what changed. Every edit gives the scene a new version and tags the edited
+// object with it; the renderer refits its acceleration structure for the objects tagged since it last looked.
+// Adding or removing objects changes the structure version, which makes it recompile the whole scene.
+struct Scene
+{
+	std::vector<std::unique_ptr<SceneObject>> Objects;
+	std::vector<Material> materials;
+
+	void AddObject(std::unique_ptr<SceneObject> object)
+	{
+		SyncObjectVersions();
+		Objects.push_back(std::move(object));
+		MarkStructureChanged();
+		m_ObjectVersions.push_back(m_Version);
+	}
+
+	void RemoveObject(size_t index)
+	{
+		SyncObjectVersions();
+		Objects.erase(Objects.begin() + index);
+		m_ObjectVersions.erase(m_ObjectVersions.begin() + index);
+		MarkStructureChanged();
+	}
+
+	// Call after changing an object's position, shape, transform or material index
+	void MarkObjectChanged(size_t index)
+	{
+		SyncObjectVersions();
+		m_Version = NextSceneVersion();
+		m_ObjectVersions[index] = m_Version;
+	}
+
+	// Call after editing, adding or removing materials
+	void MarkMaterialsChanged() { m_Version = m_MaterialsVersion = NextSceneVersion(); }
+	// Call after editing Objects directly in a way the other functions don't describe
+	void MarkStructureChanged() { m_Version = m_StructureVersion = NextSceneVersion(); }
+
+	uint64_t GetVersion() const { return m_Version; }
+	uint64_t GetStructureVersion() const { return m_StructureVersion; }
+	uint64_t GetMaterialsVersion() const { return m_MaterialsVersion; }
+	// Version of the last edit of an object, objects added to Objects directly count as part of the structure
+	uint64_t GetObjectVersion(size_t index) const { return index < m_ObjectVersions.size() ? m_ObjectVersions[index] : m_StructureVersion; }
+private:
+	// Scenes are mostly built by pushing to Objects, the versions catch up on the first edit
+	void SyncObjectVersions() { m_ObjectVersions.resize(Objects.size(), m_StructureVersion); }
+private:
+	uint64_t m_Version = NextSceneVersion();
+	uint64_t m_StructureVersion = m_Version;
+	uint64_t m_MaterialsVersion = m_Version;
+	std::vector<uint64_t> m_ObjectVersions;
+};
\ No newline at end of file
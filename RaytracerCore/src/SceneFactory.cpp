@@ -0,0 +1,236 @@
+#include "SceneFactory.h"
+
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace Utils {
+	static uint32_t PCG_Hash(uint32_t input)
+	{
+		uint32_t state = input * 747796405u + 2891336453u;
+		uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+
+	static float RandomFloat(uint32_t& seed)
+	{
+		seed = PCG_Hash(seed);
+		return (float)seed / (float)UINT32_MAX;
+	}
+}
+
+Sphere createSphere() {
+	Sphere sphere;
+	sphere.Position = { 0.f,0.f,0.f };
+	sphere.Radius = 1.f;
+	sphere.MaterialIndex = 0;
+	return sphere;
+}
+
+Plane createPlane() {
+	Plane plane;
+	plane.Position = { 0.0f, 0.0f, 0.0f };
+	plane.Normal = { 0.0f, 1.0f, 0.0f };
+	plane.MaterialIndex = 0;
+	return plane;
+}
+
+Model createCube() {
+	// Every cube shares one geometry, only the model's transform and material differ
+	static std::shared_ptr<const MeshGeometry> cubeGeometry = [] {
+		Mesh mesh;
+
+		// Define the vertices of the cube
+		mesh.Positions = {
+			glm::vec3(-0.5, -0.5, -0.5),
+			glm::vec3(0.5, -0.5, -0.5),
+			glm::vec3(0.5, 0.5, -0.5),
+			glm::vec3(-0.5, 0.5, -0.5),
+			glm::vec3(-0.5, -0.5, 0.5),
+			glm::vec3(0.5, -0.5, 0.5),
+			glm::vec3(0.5, 0.5, 0.5),
+			glm::vec3(-0.5, 0.5, 0.5)
+		};
+
+		// Define the indices for the triangles that make up each face
+		mesh.Indices = {
+			0, 1, 2, 0, 2, 3, // Front face
+			1, 5, 6, 1, 6, 2, // Right face
+			5, 4, 7, 5, 7, 6, // Back face
+			4, 0, 3, 4, 3, 7, // Left face
+			3, 2, 6, 3, 6, 7, // Top face
+			4, 5, 1, 4, 1, 0  // Bottom face
+		};
+
+		return std::make_shared<const MeshGeometry>(std::make_shared<const Mesh>(std::move(mesh)));
+	}();
+
+	return Model(cubeGeometry, glm::vec3(0.0f, 0.0f, 0.0f), 0);
+}
+
+Scene CreateDefaultScene()
+{
+	Scene scene;
+	scene.materials.push_back(Material{ { 1.0f, 0.0f, 0.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f , { 1.0f, 1.0f, 1.0f } , 5.0f});
+
+	{
+		Sphere sphere;
+		sphere.Position = { 5.f,5.f,-1.f };
+		sphere.Radius = 2.f;
+		sphere.MaterialIndex = 2;
+		scene.Objects.push_back(std::make_unique<Sphere>(sphere));
+	}
+	{
+		Sphere sphere = createSphere();
+		scene.Objects.push_back(std::make_unique<Sphere>(sphere));
+	}
+	{
+		Plane plane = createPlane();
+		plane.Position.y = -1;
+		plane.MaterialIndex = 1;
+		scene.Objects.push_back(std::make_unique<Plane>(plane));
+	}
+	{
+		Model cube = createCube();
+		cube.Position.x = 3.0f;
+		cube.MaterialIndex = 1;
+		scene.Objects.push_back(std::make_unique<Model>(cube));
+	}
+
+	return scene;
+}
+
+Model createTorus(float majorRadius, float minorRadius, uint32_t segments) {
+	Mesh mesh;
+	mesh.Positions.reserve(segments * segments);
+	for (uint32_t i = 0; i < segments; i++) {
+		for (uint32_t j = 0; j < segments; j++) {
+			float u = (float)i / (float)segments * 2.0f * glm::pi<float>();
+			float v = (float)j / (float)segments * 2.0f * glm::pi<float>();
+			float ring = majorRadius + minorRadius * std::cos(v);
+			mesh.Positions.push_back({ ring * std::cos(u), ring * std::sin(u), minorRadius * std::sin(v) });
+		}
+	}
+
+	// The surface wraps around in both directions, so the last row and column connect back to the first
+	auto vertexAt = [segments](uint32_t i, uint32_t j) { return (i % segments) * segments + j % segments; };
+	mesh.Indices.reserve(6 * segments * segments);
+	for (uint32_t i = 0; i < segments; i++) {
+		for (uint32_t j = 0; j < segments; j++) {
+			uint32_t v00 = vertexAt(i, j), v10 = vertexAt(i + 1, j);
+			uint32_t v01 = vertexAt(i, j + 1), v11 = vertexAt(i + 1, j + 1);
+			mesh.Indices.insert(mesh.Indices.end(), { v00, v10, v11, v00, v11, v01 });
+		}
+	}
+
+	return Model(std::make_shared<const Mesh>(std::move(mesh)), glm::vec3(0.0f, 0.0f, 0.0f), 0);
+}
+
+Scene CreateSphereFieldScene(uint32_t sphereCount)
+{
+	Scene scene;
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 0.2f, 0.2f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 0.2f, 0.4f, 1.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f , { 1.0f, 1.0f, 1.0f } , 5.0f});
+
+	{
+		Plane plane = createPlane();
+		plane.Position.y = -1;
+		scene.Objects.push_back(std::make_unique<Plane>(plane));
+	}
+	{
+		Sphere light(glm::vec3(0.0f, 20.0f, -10.0f), 8.0f, 3);
+		scene.Objects.push_back(std::make_unique<Sphere>(light));
+	}
+
+	// Fill a square grid in front of the default camera, jittering size and material per sphere
+	uint32_t side = (uint32_t)std::ceil(std::sqrt((float)sphereCount));
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < sphereCount; i++) {
+		float radius = 0.2f + 0.25f * Utils::RandomFloat(seed);
+		float x = (float)(i % side) - 0.5f * (float)side;
+		float z = -(float)(i / side);
+		int material = (int)(Utils::RandomFloat(seed) * 3.0f) % 3;
+		scene.Objects.push_back(std::make_unique<Sphere>(glm::vec3(x, radius - 1.0f, z), radius, material));
+	}
+
+	return scene;
+}
+
+Scene CreateMeshScene(uint32_t segments)
+{
+	Scene scene;
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 0.9f, 0.6f, 0.2f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f , { 1.0f, 1.0f, 1.0f } , 5.0f});
+
+	{
+		Plane plane = createPlane();
+		plane.Position.y = -3;
+		scene.Objects.push_back(std::make_unique<Plane>(plane));
+	}
+	{
+		Sphere light(glm::vec3(5.0f, 8.0f, 2.0f), 3.0f, 2);
+		scene.Objects.push_back(std::make_unique<Sphere>(light));
+	}
+	{
+		Model torus = createTorus(2.0f, 0.8f, segments);
+		torus.MaterialIndex = 1;
+		scene.Objects.push_back(std::make_unique<Model>(std::move(torus)));
+	}
+
+	return scene;
+}
+
+Scene CreateInstancedScene(uint32_t instanceCount)
+{
+	Scene scene;
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 0.9f, 0.6f, 0.2f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 0.3f, 0.8f, 0.4f }, 0.1f, 1.f });
+	scene.materials.push_back(Material{ { 1.0f, 1.0f, 1.0f }, 0.1f, 1.f , { 1.0f, 1.0f, 1.0f } , 5.0f});
+
+	{
+		Plane plane = createPlane();
+		plane.Position.y = -1;
+		scene.Objects.push_back(std::make_unique<Plane>(plane));
+	}
+	{
+		Sphere light(glm::vec3(0.0f, 20.0f, -10.0f), 8.0f, 3);
+		scene.Objects.push_back(std::make_unique<Sphere>(light));
+	}
+
+	// One torus is built once and placed instanceCount times on a grid with a random orientation and size
+	const std::shared_ptr<const MeshGeometry> torus = createTorus(1.5f, 0.5f, 64).GetSharedGeometry();
+	const uint32_t side = (uint32_t)std::ceil(std::sqrt((float)instanceCount));
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		float scale = 0.2f + 0.2f * Utils::RandomFloat(seed);
+		float x = 2.0f * (float)(i % side) - (float)side;
+		float z = -2.0f * (float)(i / side);
+		int material = 1 + (int)(Utils::RandomFloat(seed) * 2.0f) % 2;
+		auto model = std::make_unique<Model>(torus, glm::vec3(x, 2.0f * scale - 1.0f, z), material);
+		model->Rotation = glm::vec3(Utils::RandomFloat(seed), Utils::RandomFloat(seed), Utils::RandomFloat(seed)) * 360.0f;
+		model->Scale = glm::vec3(scale);
+		scene.Objects.push_back(std::move(model));
+	}
+
+	return scene;
+}
+
+bool CreateSceneByName(const std::string& name, Scene& scene)
+{
+	if (name == "default")
+		scene = CreateDefaultScene();
+	else if (name == "spheres")
+		scene = CreateSphereFieldScene(10000);
+	else if (name == "mesh")
+		scene = CreateMeshScene(256);
+	else if (name == "instances")
+		scene = CreateInstancedScene(4096);
+	else
+		return false;
+	return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <string>
+
+Sphere createSphere();
+Plane createPlane();
+Model createCube();
+// Torus around the z axis with 2 * segments * segments triangles
+Model createTorus(float majorRadius, float minorRadius, uint32_t segments);
+
+// The scene the interactive app starts with, also the default for offline renders
+Scene CreateDefaultScene();
+// Grid of sphereCount small spheres on a ground plane, stresses the scene BVH and the sphere kernels
+Scene CreateSphereFieldScene(uint32_t sphereCount);
+// One dense torus mesh, stresses the mesh BVH and the triangle kernels
+Scene CreateMeshScene(uint32_t segments);
+// instanceCount randomly rotated and scaled copies of one torus sharing its geometry, stresses the top level BVH
+// and the object space transforms while keeping the memory of a single mesh
+Scene CreateInstancedScene(uint32_t instanceCount);
+
+// Built-in scenes by name: "default", "spheres", "mesh" or "instances". Returns false for unknown names.
+bool CreateSceneByName(const std::string& name, Scene& scene);
@@ -0,0 +1,388 @@
+#include "SceneIO.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <type_traits>
+
+namespace Utils {
+	static constexpr char SceneMagic[8] = { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0' };
+	static constexpr uint32_t SceneVersion = 2;
+	// Written as a native uint32_t, reads back differently on a machine of the other endianness
+	static constexpr uint32_t EndianTag = 0x01020304u;
+	static constexpr uint64_t SectionAlignment = 64;
+
+	struct FileHeader
+	{
+		char Magic[8];
+		uint32_t Version;
+		uint32_t Endian;
+		uint64_t FileSize;
+		uint32_t MaterialCount, ObjectCount, MeshCount, Reserved;
+		uint64_t MaterialsOffset, ObjectsOffset, MeshesOffset;
+	};
+
+	struct FileObject
+	{
+		uint32_t Type;          // ObjectType
+		int32_t MaterialIndex;
+		uint32_t MeshIndex;     // Models only
+		float Radius;           // Spheres only
+		glm::vec3 Position;
+		glm::vec3 Normal;       // Planes only
+		glm::vec3 Rotation;     // Models only, Euler angles in degrees
+		glm::vec3 Scale;        // Models only
+	};
+
+	// One mesh geometry shared by any number of models, with its BVH
+	struct FileMesh
+	{
+		uint64_t PositionsOffset, NormalsOffset, IndicesOffset, NormalIndicesOffset;
+		uint64_t NodesOffset, PrimitiveIndicesOffset;
+		uint32_t PositionCount, NormalCount, IndexCount, NormalIndexCount;
+		uint32_t NodeCount, MaxLeafSize, BatchWidth, Reserved;
+	};
+
+	// Sections hold the in-memory representation as it is, which is only portable while these hold
+	static_assert(sizeof(glm::vec3) == 12, "glm::vec3 must be tightly packed");
+	static_assert(sizeof(Material) == 36 && std::is_trivially_copyable<Material>::value, "Material layout changed, bump SceneVersion");
+	static_assert(sizeof(BVHNode) == 32 && std::is_trivially_copyable<BVHNode>::value, "BVHNode layout changed, bump SceneVersion");
+
+	static std::string GetExtension(const std::string& path)
+	{
+		size_t dot = path.find_last_of('.');
+		if (dot == std::string::npos)
+			return "";
+
+		std::string extension = path.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+		return extension;
+	}
+
+	// Builds the file in memory, every appended section starts on a SectionAlignment boundary
+	class SectionWriter
+	{
+	public:
+		uint64_t Reserve(size_t size)
+		{
+			Data.resize((Data.size() + SectionAlignment - 1) / SectionAlignment * SectionAlignment);
+			uint64_t offset = Data.size();
+			Data.resize(Data.size() + size);
+			return offset;
+		}
+
+		template<typename T>
+		uint64_t Append(const std::vector<T>& values)
+		{
+			uint64_t offset = Reserve(values.size() * sizeof(T));
+			if (!values.empty())
+				std::memcpy(Data.data() + offset, values.data(), values.size() * sizeof(T));
+			return offset;
+		}
+
+		template<typename T>
+		void Write(uint64_t offset, const T& value) { std::memcpy(Data.data() + offset, &value, sizeof(T)); }
+	public:
+		std::vector<char> Data;
+	};
+
+	// Bounds checked view of the mapped file
+	class SectionReader
+	{
+	public:
+		SectionReader(const char* data, uint64_t size) : m_Data(data), m_Size(size) {}
+
+		template<typename T>
+		bool Read(uint64_t offset, uint64_t count, std::vector<T>& values) const
+		{
+			if (!Contains(offset, count, sizeof(T)))
+				return false;
+			values.resize(count);
+			if (count > 0)
+				std::memcpy(values.data(), m_Data + offset, count * sizeof(T));
+			return true;
+		}
+
+		template<typename T>
+		bool Read(uint64_t offset, T& value) const
+		{
+			if (!Contains(offset, 1, sizeof(T)))
+				return false;
+			std::memcpy(&value, m_Data + offset, sizeof(T));
+			return true;
+		}
+	private:
+		bool Contains(uint64_t offset, uint64_t count, uint64_t elementSize) const
+		{
+			if (offset % SectionAlignment != 0 || offset > m_Size)
+				return false;
+			return count <= (m_Size - offset) / elementSize;
+		}
+	private:
+		const char* m_Data;
+		uint64_t m_Size;
+	};
+
+	// The nodes must form a tree the traversal stacks can hold: every child comes after its parent and has no other
+	// parent, no node is deeper than BVH::MaxDepth and leaves stay inside the primitive range
+	static bool IsValidBVH(const std::vector<BVHNode>& nodes, const std::vector<uint32_t>& primitiveIndices, uint32_t primitiveCount)
+	{
+		for (uint32_t index : primitiveIndices)
+			if (index >= primitiveCount)
+				return false;
+
+		// Depth of every node reached so far, 0 for nodes no parent refers to yet
+		std::vector<uint32_t> depths(nodes.size(), 0);
+		if (!nodes.empty())
+			depths[0] = 1;
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			const BVHNode& node = nodes[i];
+			if (depths[i] == 0)
+				return false;
+			if (node.IsLeaf())
+			{
+				if ((uint64_t)node.LeftFirst + node.Count > primitiveIndices.size())
+					return false;
+				continue;
+			}
+
+			if (node.LeftFirst <= i || (uint64_t)node.LeftFirst + 1 >= nodes.size() || depths[i] > BVH::MaxDepth
+				|| depths[node.LeftFirst] != 0 || depths[node.LeftFirst + 1] != 0)
+				return false;
+			depths[node.LeftFirst] = depths[node.LeftFirst + 1] = depths[i] + 1;
+		}
+		return true;
+	}
+}
+
+bool SaveSceneBinary(const std::string& path, const Scene& scene, std::string& error)
+{
+	Utils::SectionWriter writer;
+	const uint64_t headerOffset = writer.Reserve(sizeof(Utils::FileHeader));
+
+	Utils::FileHeader header{};
+	std::memcpy(header.Magic, Utils::SceneMagic, sizeof(header.Magic));
+	header.Version = Utils::SceneVersion;
+	header.Endian = Utils::EndianTag;
+	header.MaterialCount = (uint32_t)scene.materials.size();
+	header.MaterialsOffset = writer.Append(scene.materials);
+
+	// Models instancing the same geometry share its entry
+	std::vector<const MeshGeometry*> geometries;
+	std::unordered_map<const MeshGeometry*, uint32_t> meshIndices;
+	std::vector<Utils::FileObject> objects;
+	objects.reserve(scene.Objects.size());
+	for (const auto& object : scene.Objects)
+	{
+		Utils::FileObject record{};
+		record.Type = (uint32_t)object->GetType();
+		record.MaterialIndex = object->MaterialIndex;
+		record.Position = object->Position;
+		switch (object->GetType())
+		{
+		case ObjectType::Sphere:
+			record.Radius = static_cast<const Sphere&>(*object).Radius;
+			break;
+		case ObjectType::Plane:
+			record.Normal = static_cast<const Plane&>(*object).Normal;
+			break;
+		case ObjectType::Model:
+		{
+			const Model& model = static_cast<const Model&>(*object);
+			auto inserted = meshIndices.emplace(&model.GetGeometry(), (uint32_t)geometries.size());
+			if (inserted.second)
+				geometries.push_back(&model.GetGeometry());
+			record.MeshIndex = inserted.first->second;
+			record.Rotation = model.Rotation;
+			record.Scale = model.Scale;
+			break;
+		}
+		}
+		objects.push_back(record);
+	}
+	header.ObjectCount = (uint32_t)objects.size();
+	header.ObjectsOffset = writer.Append(objects);
+
+	header.MeshCount = (uint32_t)geometries.size();
+	header.MeshesOffset = writer.Reserve(geometries.size() * sizeof(Utils::FileMesh));
+	for (size_t i = 0; i < geometries.size(); i++)
+	{
+		const Mesh& mesh = geometries[i]->GetMesh();
+		const BVH& bvh = geometries[i]->GetBVH();
+
+		Utils::FileMesh record{};
+		record.PositionCount = (uint32_t)mesh.Positions.size();
+		record.NormalCount = (uint32_t)mesh.Normals.size();
+		record.IndexCount = (uint32_t)mesh.Indices.size();
+		record.NormalIndexCount = (uint32_t)mesh.NormalIndices.size();
+		record.NodeCount = (uint32_t)bvh.GetNodes().size();
+		record.MaxLeafSize = bvh.GetMaxLeafSize();
+		record.BatchWidth = bvh.GetBatchWidth();
+		record.PositionsOffset = writer.Append(mesh.Positions);
+		record.NormalsOffset = writer.Append(mesh.Normals);
+		record.IndicesOffset = writer.Append(mesh.Indices);
+		record.NormalIndicesOffset = writer.Append(mesh.NormalIndices);
+		record.NodesOffset = writer.Append(bvh.GetNodes());
+		record.PrimitiveIndicesOffset = writer.Append(bvh.GetPrimitiveIndices());
+		writer.Write(header.MeshesOffset + i * sizeof(Utils::FileMesh), record);
+	}
+
+	header.FileSize = writer.Data.size();
+	writer.Write(headerOffset, header);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		error = "Can't create " + path;
+		return false;
+	}
+	file.write(writer.Data.data(), (std::streamsize)writer.Data.size());
+	if (!file)
+	{
+		error = "Failed to write " + path;
+		return false;
+	}
+	return true;
+}
+
+bool LoadSceneBinary(const std::string& path, Scene& scene, std::string& error)
+{
+	scene = Scene{};
+
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		error = "Can't open " + path;
+		return false;
+	}
+
+	const std::string corrupt = path + " is truncated or corrupt";
+	const Utils::SectionReader reader(file.GetData(), file.GetSize());
+	Utils::FileHeader header;
+	if (!reader.Read(0, header) || std::memcmp(header.Magic, Utils::SceneMagic, sizeof(header.Magic)) != 0)
+	{
+		error = path + " is not a scene file";
+		return false;
+	}
+	if (header.Endian != Utils::EndianTag)
+	{
+		error = path + " was written on a machine of the other endianness";
+		return false;
+	}
+	if (header.Version != Utils::SceneVersion)
+	{
+		error = path + " has scene format version " + std::to_string(header.Version) + ", expected " + std::to_string(Utils::SceneVersion);
+		return false;
+	}
+
+	std::vector<Utils::FileObject> objects;
+	std::vector<Utils::FileMesh> meshRecords;
+	if (header.FileSize != file.GetSize()
+		|| !reader.Read(header.MaterialsOffset, header.MaterialCount, scene.materials)
+		|| !reader.Read(header.ObjectsOffset, header.ObjectCount, objects)
+		|| !reader.Read(header.MeshesOffset, header.MeshCount, meshRecords))
+	{
+		error = corrupt;
+		return false;
+	}
+
+	// Every mesh and its prebuilt BVH become one geometry that all of its models instance
+	std::vector<std::shared_ptr<const MeshGeometry>> geometries;
+	geometries.reserve(meshRecords.size());
+	for (size_t i = 0; i < meshRecords.size(); i++)
+	{
+		const Utils::FileMesh& record = meshRecords[i];
+		auto mesh = std::make_shared<Mesh>();
+		std::vector<BVHNode> nodes;
+		std::vector<uint32_t> primitiveIndices;
+		if (!reader.Read(record.PositionsOffset, record.PositionCount, mesh->Positions)
+			|| !reader.Read(record.NormalsOffset, record.NormalCount, mesh->Normals)
+			|| !reader.Read(record.IndicesOffset, record.IndexCount, mesh->Indices)
+			|| !reader.Read(record.NormalIndicesOffset, record.NormalIndexCount, mesh->NormalIndices)
+			|| !reader.Read(record.NodesOffset, record.NodeCount, nodes)
+			|| !reader.Read(record.PrimitiveIndicesOffset, mesh->GetTriangleCount(), primitiveIndices)
+			|| !mesh->IsValid()
+			|| !Utils::IsValidBVH(nodes, primitiveIndices, (uint32_t)mesh->GetTriangleCount())
+			|| (nodes.empty() && mesh->GetTriangleCount() > 0))
+		{
+			scene = Scene{};
+			error = corrupt;
+			return false;
+		}
+
+		BVH bvh;
+		bvh.Assign(std::move(nodes), std::move(primitiveIndices), record.MaxLeafSize, record.BatchWidth);
+		geometries.push_back(std::make_shared<const MeshGeometry>(std::move(mesh), std::move(bvh)));
+	}
+
+	scene.Objects.reserve(objects.size());
+	for (const Utils::FileObject& record : objects)
+	{
+		if (record.MaterialIndex < 0 || (size_t)record.MaterialIndex >= scene.materials.size())
+		{
+			scene = Scene{};
+			error = corrupt;
+			return false;
+		}
+
+		switch ((ObjectType)record.Type)
+		{
+		case ObjectType::Sphere:
+			scene.Objects.push_back(std::make_unique<Sphere>(record.Position, record.Radius, record.MaterialIndex));
+			continue;
+		case ObjectType::Plane:
+			scene.Objects.push_back(std::make_unique<Plane>(record.Position, record.Normal, record.MaterialIndex));
+			continue;
+		case ObjectType::Model:
+			if (record.MeshIndex < geometries.size() && Model::IsValidScale(record.Scale))
+			{
+				auto model = std::make_unique<Model>(geometries[record.MeshIndex], record.Position, record.MaterialIndex);
+				model->Rotation = record.Rotation;
+				model->Scale = record.Scale;
+				scene.Objects.push_back(std::move(model));
+				continue;
+			}
+			break;
+		}
+
+		scene = Scene{};
+		error = corrupt;
+		return false;
+	}
+	return true;
+}
+
+bool SaveScene(const std::string& path, const Scene& scene, std::string& error)
+{
+	std::string extension = Utils::GetExtension(path);
+	if (extension == "rtscene")
+		return SaveSceneBinary(path, scene, error);
+	if (extension == "json")
+		return SaveSceneJSON(path, scene, error);
+
+	error = "Unsupported scene format: " + path;
+	return false;
+}
+
+bool LoadScene(const std::string& path, Scene& scene, std::string& error)
+{
+	std::string extension = Utils::GetExtension(path);
+	if (extension == "rtscene")
+		return LoadSceneBinary(path, scene, error);
+	if (extension == "json")
+		return LoadSceneJSON(path, scene, error);
+
+	error = "Unsupported scene format: " + path;
+	return false;
+}
+
+bool IsSceneFile(const std::string& path)
+{
+	std::string extension = Utils::GetExtension(path);
+	return extension == "rtscene" || extension == "json";
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "Scene.h"
+
+// Scene files. On failure the functions return false and describe the problem in error, a scene that failed to
+// load is left empty.
+
+// Binary .rtscene: materials, objects, the meshes the models instance and each mesh's prebuilt BVH. Every array
+// is stored as a 64 byte aligned section in exactly the layout the renderer keeps in memory, so loading maps the
+// file and copies sections in bulk instead of parsing text and rebuilding BVHs. Files carry a version and a byte
+// order tag, files of another version or byte order are rejected.
+bool SaveSceneBinary(const std::string& path, const Scene& scene, std::string& error);
+bool LoadSceneBinary(const std::string& path, Scene& scene, std::string& error);
+
+// Human readable JSON for authoring. Meshes are written inline, on import a mesh may also name an .obj or .ply
+// file with "path", relative to the JSON file. BVHs are always rebuilt on import.
+bool SaveSceneJSON(const std::string& path, const Scene& scene, std::string& error);
+bool LoadSceneJSON(const std::string& path, Scene& scene, std::string& error);
+
+// Picks the format from the file extension (.rtscene or .json)
+bool SaveScene(const std::string& path, const Scene& scene, std::string& error);
+bool LoadScene(const std::string& path, Scene& scene, std::string& error);
+// True for paths LoadScene can read, to tell scene files from built-in scene names
+bool IsSceneFile(const std::string& path);
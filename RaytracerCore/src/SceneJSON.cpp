@@ -0,0 +1,786 @@
+#include "SceneIO.h"
+#include "MappedFile.h"
+#include "MeshLoader.h"
+
+#include <cfloat>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Utils {
+	static constexpr int SceneJSONVersion = 1;
+
+	static const char* GetObjectTypeName(ObjectType type)
+	{
+		switch (type)
+		{
+		case ObjectType::Sphere: return "sphere";
+		case ObjectType::Plane:  return "plane";
+		case ObjectType::Model:  return "model";
+		}
+		return "unknown";
+	}
+
+	// Mesh paths in a scene are relative to the scene file unless they are absolute
+	static std::string ResolvePath(const std::string& scenePath, const std::string& path)
+	{
+		bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+		size_t slash = scenePath.find_last_of("/\\");
+		if (absolute || slash == std::string::npos)
+			return path;
+		return scenePath.substr(0, slash + 1) + path;
+	}
+}
+
+namespace {
+	struct JSONValue
+	{
+		enum class Kind
+		{
+			Null, Bool, Number, String, Array, Object
+		};
+
+		Kind Type = Kind::Null;
+		bool Bool = false;
+		double Number = 0.0;
+		std::string String;
+		std::vector<JSONValue> Elements;
+		std::vector<std::pair<std::string, JSONValue>> Members;
+
+		const JSONValue* Find(const char* key) const
+		{
+			for (const auto& member : Members)
+				if (member.first == key)
+					return &member.second;
+			return nullptr;
+		}
+	};
+
+	// Recursive descent parser for RFC 8259 JSON, building the whole document in memory
+	class JSONParser
+	{
+	public:
+		JSONParser(const char* begin, const char* end) : m_Begin(begin), m_P(begin), m_End(end) {}
+
+		bool Parse(JSONValue& value, std::string& error)
+		{
+			bool parsed = ParseValue(value, 0);
+			SkipWhitespace();
+			if (parsed && m_P != m_End)
+				parsed = Fail("unexpected data after the document");
+			if (!parsed)
+			{
+				error = m_Error + " at line " + std::to_string(GetLine());
+				return false;
+			}
+			return true;
+		}
+	private:
+		// Deeper documents are rejected rather than risking the stack
+		static constexpr int MaxNesting = 64;
+
+		bool Fail(const char* message)
+		{
+			m_Error = message;
+			return false;
+		}
+
+		size_t GetLine() const
+		{
+			size_t line = 1;
+			for (const char* p = m_Begin; p < m_P; p++)
+				line += *p == '\n';
+			return line;
+		}
+
+		void SkipWhitespace()
+		{
+			while (m_P < m_End && (*m_P == ' ' || *m_P == '\t' || *m_P == '\n' || *m_P == '\r'))
+				m_P++;
+		}
+
+		bool Consume(char c)
+		{
+			SkipWhitespace();
+			if (m_P < m_End && *m_P == c)
+			{
+				m_P++;
+				return true;
+			}
+			return false;
+		}
+
+		bool ConsumeLiteral(const char* literal)
+		{
+			size_t length = std::char_traits<char>::length(literal);
+			if ((size_t)(m_End - m_P) < length || std::char_traits<char>::compare(m_P, literal, length) != 0)
+				return false;
+			m_P += length;
+			return true;
+		}
+
+		bool ParseValue(JSONValue& value, int depth)
+		{
+			SkipWhitespace();
+			if (m_P == m_End)
+				return Fail("unexpected end of file");
+
+			switch (*m_P)
+			{
+			case '{': return ParseObject(value, depth);
+			case '[': return ParseArray(value, depth);
+			case '"':
+				value.Type = JSONValue::Kind::String;
+				return ParseString(value.String);
+			case 't':
+			case 'f':
+				value.Type = JSONValue::Kind::Bool;
+				value.Bool = *m_P == 't';
+				return ConsumeLiteral(value.Bool ? "true" : "false") || Fail("invalid literal");
+			case 'n':
+				value.Type = JSONValue::Kind::Null;
+				return ConsumeLiteral("null") || Fail("invalid literal");
+			default:
+				return ParseNumber(value);
+			}
+		}
+
+		bool ParseNumber(JSONValue& value)
+		{
+			// from_chars would also take inf and nan, with or without a sign, which JSON does not have. A number
+			// starts with a digit, after the minus sign if there is one.
+			auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+			if (!isDigit(*m_P) && (*m_P != '-' || m_End - m_P < 2 || !isDigit(m_P[1])))
+				return Fail(*m_P == '-' ? "invalid number" : "unexpected character");
+
+			std::from_chars_result result = std::from_chars(m_P, m_End, value.Number);
+			if (result.ec != std::errc())
+				return Fail("invalid number");
+			m_P = result.ptr;
+			value.Type = JSONValue::Kind::Number;
+			return true;
+		}
+
+		bool ParseHex4(uint32_t& codeUnit)
+		{
+			if (m_End - m_P < 4)
+				return Fail("invalid \\u escape");
+			codeUnit = 0;
+			for (int i = 0; i < 4; i++, m_P++)
+			{
+				char c = *m_P;
+				uint32_t digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+				if (digit == 16)
+					return Fail("invalid \\u escape");
+				codeUnit = codeUnit * 16 + digit;
+			}
+			return true;
+		}
+
+		static void AppendUTF8(std::string& string, uint32_t codePoint)
+		{
+			if (codePoint < 0x80)
+				string += (char)codePoint;
+			else if (codePoint < 0x800)
+			{
+				string += (char)(0xc0 | codePoint >> 6);
+				string += (char)(0x80 | (codePoint & 0x3f));
+			}
+			else if (codePoint < 0x10000)
+			{
+				string += (char)(0xe0 | codePoint >> 12);
+				string += (char)(0x80 | (codePoint >> 6 & 0x3f));
+				string += (char)(0x80 | (codePoint & 0x3f));
+			}
+			else
+			{
+				string += (char)(0xf0 | codePoint >> 18);
+				string += (char)(0x80 | (codePoint >> 12 & 0x3f));
+				string += (char)(0x80 | (codePoint >> 6 & 0x3f));
+				string += (char)(0x80 | (codePoint & 0x3f));
+			}
+		}
+
+		bool ParseString(std::string& string)
+		{
+			if (!Consume('"'))
+				return Fail("expected a string");
+
+			while (true)
+			{
+				if (m_P == m_End)
+					return Fail("unterminated string");
+
+				char c = *m_P++;
+				if (c == '"')
+					return true;
+				if ((unsigned char)c < 0x20)
+					return Fail("control character in string");
+				if (c != '\\')
+				{
+					string += c;
+					continue;
+				}
+
+				if (m_P == m_End)
+					return Fail("unterminated string");
+				switch (*m_P++)
+				{
+				case '"':  string += '"'; break;
+				case '\\': string += '\\'; break;
+				case '/':  string += '/'; break;
+				case 'b':  string += '\b'; break;
+				case 'f':  string += '\f'; break;
+				case 'n':  string += '\n'; break;
+				case 'r':  string += '\r'; break;
+				case 't':  string += '\t'; break;
+				case 'u':
+				{
+					uint32_t codePoint;
+					if (!ParseHex4(codePoint))
+						return false;
+					// Characters outside the basic plane are escaped as a surrogate pair
+					if (codePoint >= 0xd800 && codePoint < 0xdc00)
+					{
+						uint32_t low;
+						if (!ConsumeLiteral("\\u") || !ParseHex4(low) || low < 0xdc00 || low >= 0xe000)
+							return Fail("unpaired surrogate in string");
+						codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+					}
+					AppendUTF8(string, codePoint);
+					break;
+				}
+				default:
+					return Fail("invalid escape in string");
+				}
+			}
+		}
+
+		bool ParseArray(JSONValue& value, int depth)
+		{
+			if (depth >= MaxNesting)
+				return Fail("nested too deeply");
+
+			m_P++;
+			value.Type = JSONValue::Kind::Array;
+			if (Consume(']'))
+				return true;
+			do
+			{
+				value.Elements.emplace_back();
+				if (!ParseValue(value.Elements.back(), depth + 1))
+					return false;
+			} while (Consume(','));
+			return Consume(']') || Fail("expected , or ]");
+		}
+
+		bool ParseObject(JSONValue& value, int depth)
+		{
+			if (depth >= MaxNesting)
+				return Fail("nested too deeply");
+
+			m_P++;
+			value.Type = JSONValue::Kind::Object;
+			if (Consume('}'))
+				return true;
+			do
+			{
+				value.Members.emplace_back();
+				if (!ParseString(value.Members.back().first))
+					return false;
+				if (!Consume(':'))
+					return Fail("expected :");
+				if (!ParseValue(value.Members.back().second, depth + 1))
+					return false;
+			} while (Consume(','));
+			return Consume('}') || Fail("expected , or }");
+		}
+	private:
+		const char* m_Begin;
+		const char* m_P;
+		const char* m_End;
+		std::string m_Error;
+	};
+
+	// Reads the typed fields of a parsed document. The first problem found is kept in Error, later reads then
+	// fail too, so a whole object can be read before checking once.
+	class SceneReader
+	{
+	public:
+		std::string Error;
+
+		const JSONValue* Get(const JSONValue& object, const char* key, JSONValue::Kind type)
+		{
+			const JSONValue* value = object.Find(key);
+			if (value && value->Type != type)
+				SetError(std::string("\"") + key + "\" has the wrong type");
+			return value && value->Type == type ? value : nullptr;
+		}
+
+		const JSONValue* GetRequired(const JSONValue& object, const char* key, JSONValue::Kind type)
+		{
+			const JSONValue* value = Get(object, key, type);
+			if (!value && !object.Find(key))
+				SetError(std::string("missing \"") + key + "\"");
+			return value;
+		}
+
+		void Read(const JSONValue& object, const char* key, float& result)
+		{
+			const JSONValue* value = Get(object, key, JSONValue::Kind::Number);
+			if (!value)
+				return;
+			if (!IsFloat(value->Number))
+			{
+				SetError(std::string("\"") + key + "\" is out of range");
+				return;
+			}
+			result = (float)value->Number;
+		}
+
+		void Read(const JSONValue& object, const char* key, glm::vec3& result)
+		{
+			const JSONValue* value = Get(object, key, JSONValue::Kind::Array);
+			if (!value)
+				return;
+			if (value->Elements.size() != 3 || !IsNumbers(*value))
+			{
+				SetError(std::string("\"") + key + "\" must be an array of three numbers");
+				return;
+			}
+			if (!IsFloats(*value))
+			{
+				SetError(std::string("\"") + key + "\" is out of range");
+				return;
+			}
+			for (int i = 0; i < 3; i++)
+				result[i] = (float)value->Elements[i].Number;
+		}
+
+		// Required index into a list of count entries
+		void ReadIndex(const JSONValue& object, const char* key, size_t count, int& result)
+		{
+			const JSONValue* value = GetRequired(object, key, JSONValue::Kind::Number);
+			if (!value)
+				return;
+			if (value->Number < 0.0 || value->Number >= (double)count || value->Number != std::floor(value->Number))
+			{
+				SetError(std::string("\"") + key + "\" is out of range");
+				return;
+			}
+			result = (int)value->Number;
+		}
+
+		// Flat array of numbers, three per element for vectors and one for indices
+		template<typename T>
+		void ReadArray(const JSONValue& object, const char* key, std::vector<T>& result)
+		{
+			const JSONValue* value = Get(object, key, JSONValue::Kind::Array);
+			if (!value)
+				return;
+
+			constexpr size_t componentCount = sizeof(T) / sizeof(float);
+			if (value->Elements.size() % componentCount != 0 || !IsNumbers(*value))
+			{
+				SetError(std::string("\"") + key + "\" must be a flat array of numbers");
+				return;
+			}
+			// Indices are range checked by Mesh::IsValid instead
+			if (std::is_same<T, glm::vec3>::value && !IsFloats(*value))
+			{
+				SetError(std::string("\"") + key + "\" is out of range");
+				return;
+			}
+
+			result.resize(value->Elements.size() / componentCount);
+			for (size_t i = 0; i < value->Elements.size(); i++)
+				Store(result[i / componentCount], i % componentCount, value->Elements[i].Number);
+		}
+
+		void SetError(std::string error)
+		{
+			if (Error.empty())
+				Error = std::move(error);
+		}
+	private:
+		static bool IsNumbers(const JSONValue& array)
+		{
+			for (const JSONValue& element : array.Elements)
+				if (element.Type != JSONValue::Kind::Number)
+					return false;
+			return true;
+		}
+
+		// Whether a number converts to a float without overflowing, which would make it infinite and the scene
+		// impossible to save again
+		static bool IsFloat(double value) { return std::fabs(value) <= (double)FLT_MAX; }
+		static bool IsFloats(const JSONValue& array)
+		{
+			for (const JSONValue& element : array.Elements)
+				if (!IsFloat(element.Number))
+					return false;
+			return true;
+		}
+
+		static void Store(glm::vec3& element, size_t component, double value) { element[(int)component] = (float)value; }
+		static void Store(uint32_t& element, size_t, double value)
+		{
+			// Out of range indices are caught by Mesh::IsValid
+			element = value >= 0.0 && value <= (double)UINT32_MAX && value == std::floor(value) ? (uint32_t)value : UINT32_MAX;
+		}
+	};
+
+	// Indented JSON output. Floats are written with the fewest digits that read back as the same value.
+	class SceneWriter
+	{
+	public:
+		std::string Output;
+		bool Finite = true; // JSON can't hold infinities or NaN
+
+		void Key(const char* key) { Output.append(m_Indent).append("\"").append(key).append("\": "); }
+
+		void Number(float value)
+		{
+			Finite &= std::isfinite(value);
+			char buffer[32];
+			Output.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+		}
+
+		void String(const std::string& value)
+		{
+			Output += '"';
+			for (char c : value)
+			{
+				if (c == '"' || c == '\\')
+					Output += '\\';
+				if ((unsigned char)c < 0x20)
+				{
+					char buffer[8];
+					std::snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned)c);
+					Output += buffer;
+				}
+				else
+					Output += c;
+			}
+			Output += '"';
+		}
+
+		void Vec3(const glm::vec3& value)
+		{
+			Output += '[';
+			for (int i = 0; i < 3; i++)
+			{
+				if (i > 0)
+					Output += ", ";
+				Number(value[i]);
+			}
+			Output += ']';
+		}
+
+		template<typename T>
+		void Array(const std::vector<T>& values)
+		{
+			Output += '[';
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				if (i > 0)
+					Output += ", ";
+				Write(values[i]);
+			}
+			Output += ']';
+		}
+
+		void Open(char bracket)
+		{
+			Output += bracket;
+			Output += '\n';
+			m_Indent += '\t';
+		}
+
+		void Close(char bracket)
+		{
+			m_Indent.pop_back();
+			Output.append(m_Indent) += bracket;
+		}
+
+		void Separator(bool last) { Output += last ? "\n" : ",\n"; }
+		void Indent() { Output += m_Indent; }
+	private:
+		void Write(const glm::vec3& value)
+		{
+			Number(value.x);
+			Output += ", ";
+			Number(value.y);
+			Output += ", ";
+			Number(value.z);
+		}
+		void Write(uint32_t value) { Output += std::to_string(value); }
+	private:
+		std::string m_Indent;
+	};
+}
+
+bool SaveSceneJSON(const std::string& path, const Scene& scene, std::string& error)
+{
+	SceneWriter writer;
+	writer.Open('{');
+	writer.Key("version");
+	writer.Output += std::to_string(Utils::SceneJSONVersion);
+	writer.Separator(false);
+
+	writer.Key("materials");
+	writer.Open('[');
+	for (size_t i = 0; i < scene.materials.size(); i++)
+	{
+		const Material& material = scene.materials[i];
+		writer.Indent();
+		writer.Open('{');
+		writer.Key("albedo"); writer.Vec3(material.Albedo); writer.Separator(false);
+		writer.Key("roughness"); writer.Number(material.Roughness); writer.Separator(false);
+		writer.Key("metallic"); writer.Number(material.Metallic); writer.Separator(false);
+		writer.Key("emissionColor"); writer.Vec3(material.EmissionColor); writer.Separator(false);
+		writer.Key("emissionPower"); writer.Number(material.EmissionPower); writer.Separator(true);
+		writer.Close('}');
+		writer.Separator(i + 1 == scene.materials.size());
+	}
+	writer.Close(']');
+	writer.Separator(false);
+
+	// Models instancing the same geometry refer to the same entry of "meshes"
+	std::vector<const Mesh*> meshes;
+	std::unordered_map<const MeshGeometry*, uint32_t> meshIndices;
+	for (const auto& object : scene.Objects)
+		if (object->GetType() == ObjectType::Model)
+		{
+			const MeshGeometry* geometry = &static_cast<const Model&>(*object).GetGeometry();
+			if (meshIndices.emplace(geometry, (uint32_t)meshes.size()).second)
+				meshes.push_back(&geometry->GetMesh());
+		}
+
+	writer.Key("objects");
+	writer.Open('[');
+	for (size_t i = 0; i < scene.Objects.size(); i++)
+	{
+		const SceneObject& object = *scene.Objects[i];
+		writer.Indent();
+		writer.Open('{');
+		writer.Key("type"); writer.String(Utils::GetObjectTypeName(object.GetType())); writer.Separator(false);
+		writer.Key("position"); writer.Vec3(object.Position); writer.Separator(false);
+		switch (object.GetType())
+		{
+		case ObjectType::Sphere:
+			writer.Key("radius"); writer.Number(static_cast<const Sphere&>(object).Radius);
+			break;
+		case ObjectType::Plane:
+			writer.Key("normal"); writer.Vec3(static_cast<const Plane&>(object).Normal);
+			break;
+		case ObjectType::Model:
+		{
+			const Model& model = static_cast<const Model&>(object);
+			writer.Key("mesh"); writer.Output += std::to_string(meshIndices[&model.GetGeometry()]); writer.Separator(false);
+			writer.Key("rotation"); writer.Vec3(model.Rotation); writer.Separator(false);
+			writer.Key("scale"); writer.Vec3(model.Scale);
+			break;
+		}
+		}
+		writer.Separator(false);
+		writer.Key("material"); writer.Output += std::to_string(object.MaterialIndex); writer.Separator(true);
+		writer.Close('}');
+		writer.Separator(i + 1 == scene.Objects.size());
+	}
+	writer.Close(']');
+	writer.Separator(false);
+
+	writer.Key("meshes");
+	writer.Open('[');
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const Mesh& mesh = *meshes[i];
+		writer.Indent();
+		writer.Open('{');
+		writer.Key("positions"); writer.Array(mesh.Positions); writer.Separator(false);
+		writer.Key("indices"); writer.Array(mesh.Indices); writer.Separator(!mesh.HasNormals());
+		if (mesh.HasNormals())
+		{
+			writer.Key("normals"); writer.Array(mesh.Normals); writer.Separator(false);
+			writer.Key("normalIndices"); writer.Array(mesh.NormalIndices); writer.Separator(true);
+		}
+		writer.Close('}');
+		writer.Separator(i + 1 == meshes.size());
+	}
+	writer.Close(']');
+	writer.Separator(true);
+	writer.Close('}');
+	writer.Output += '\n';
+
+	if (!writer.Finite)
+	{
+		error = "The scene contains infinite or NaN values, which JSON can't represent";
+		return false;
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		error = "Can't create " + path;
+		return false;
+	}
+	file.write(writer.Output.data(), (std::streamsize)writer.Output.size());
+	if (!file)
+	{
+		error = "Failed to write " + path;
+		return false;
+	}
+	return true;
+}
+
+bool LoadSceneJSON(const std::string& path, Scene& scene, std::string& error)
+{
+	scene = Scene{};
+
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		error = "Can't open " + path;
+		return false;
+	}
+
+	JSONValue document;
+	JSONParser parser(file.GetData(), file.GetData() + file.GetSize());
+	if (!parser.Parse(document, error))
+	{
+		error = path + ": " + error;
+		return false;
+	}
+	file.Close();
+
+	SceneReader reader;
+	if (document.Type != JSONValue::Kind::Object)
+		reader.SetError("the document must be an object");
+	else if (const JSONValue* version = reader.Get(document, "version", JSONValue::Kind::Number))
+	{
+		if (version->Number != Utils::SceneJSONVersion)
+			reader.SetError("unsupported version " + std::to_string(version->Number));
+	}
+
+	// Missing lists are empty
+	const JSONValue emptyList;
+	const JSONValue* materials = reader.Get(document, "materials", JSONValue::Kind::Array);
+	const JSONValue* meshes = reader.Get(document, "meshes", JSONValue::Kind::Array);
+	const JSONValue* objects = reader.Get(document, "objects", JSONValue::Kind::Array);
+	materials = materials ? materials : &emptyList;
+	meshes = meshes ? meshes : &emptyList;
+	objects = objects ? objects : &emptyList;
+
+	for (const JSONValue& entry : materials->Elements)
+	{
+		if (entry.Type != JSONValue::Kind::Object)
+		{
+			reader.SetError("materials must be objects");
+			break;
+		}
+
+		Material& material = scene.materials.emplace_back();
+		reader.Read(entry, "albedo", material.Albedo);
+		reader.Read(entry, "roughness", material.Roughness);
+		reader.Read(entry, "metallic", material.Metallic);
+		reader.Read(entry, "emissionColor", material.EmissionColor);
+		reader.Read(entry, "emissionPower", material.EmissionPower);
+	}
+
+	// Inline meshes or meshes loaded from the files they name, each becomes one geometry its models instance
+	std::vector<std::shared_ptr<const Mesh>> meshData;
+	for (size_t i = 0; i < meshes->Elements.size() && reader.Error.empty(); i++)
+	{
+		const JSONValue& entry = meshes->Elements[i];
+		if (entry.Type != JSONValue::Kind::Object)
+		{
+			reader.SetError("meshes must be objects");
+			break;
+		}
+
+		auto mesh = std::make_shared<Mesh>();
+		if (const JSONValue* meshPath = reader.Get(entry, "path", JSONValue::Kind::String))
+		{
+			std::string meshError;
+			if (!LoadMesh(Utils::ResolvePath(path, meshPath->String), *mesh, meshError))
+				reader.SetError(meshError);
+		}
+		else
+		{
+			reader.ReadArray(entry, "positions", mesh->Positions);
+			reader.ReadArray(entry, "normals", mesh->Normals);
+			reader.ReadArray(entry, "indices", mesh->Indices);
+			reader.ReadArray(entry, "normalIndices", mesh->NormalIndices);
+			if (reader.Error.empty() && !mesh->IsValid())
+				reader.SetError("mesh " + std::to_string(i) + " has incomplete triangles or indices out of range");
+		}
+		meshData.push_back(std::move(mesh));
+	}
+	// Built when the first model of a mesh is read, so unused meshes never get a BVH
+	std::vector<std::shared_ptr<const MeshGeometry>> geometries(meshData.size());
+
+	for (size_t i = 0; i < objects->Elements.size() && reader.Error.empty(); i++)
+	{
+		const JSONValue& entry = objects->Elements[i];
+		const JSONValue* type = entry.Type == JSONValue::Kind::Object ? reader.GetRequired(entry, "type", JSONValue::Kind::String) : nullptr;
+		if (!type)
+		{
+			reader.SetError("objects must be objects with a \"type\"");
+			break;
+		}
+
+		glm::vec3 position{ 0.0f };
+		int material = 0;
+		reader.Read(entry, "position", position);
+		reader.ReadIndex(entry, "material", scene.materials.size(), material);
+		if (type->String == "sphere")
+		{
+			float radius = 1.0f;
+			reader.Read(entry, "radius", radius);
+			scene.Objects.push_back(std::make_unique<Sphere>(position, radius, material));
+		}
+		else if (type->String == "plane")
+		{
+			glm::vec3 normal{ 0.0f, 1.0f, 0.0f };
+			reader.Read(entry, "normal", normal);
+			scene.Objects.push_back(std::make_unique<Plane>(position, normal, material));
+		}
+		else if (type->String == "model")
+		{
+			int mesh = 0;
+			glm::vec3 rotation{ 0.0f };
+			glm::vec3 scale{ 1.0f };
+			reader.ReadIndex(entry, "mesh", meshData.size(), mesh);
+			reader.Read(entry, "rotation", rotation);
+			reader.Read(entry, "scale", scale);
+			if (reader.Error.empty() && !Model::IsValidScale(scale))
+				reader.SetError("\"scale\" must not have a zero component");
+			if (!reader.Error.empty())
+				break;
+
+			if (!geometries[mesh])
+				geometries[mesh] = std::make_shared<const MeshGeometry>(meshData[mesh]);
+			auto model = std::make_unique<Model>(geometries[mesh], position, material);
+			model->Rotation = rotation;
+			model->Scale = scale;
+			scene.Objects.push_back(std::move(model));
+		}
+		else
+			reader.SetError("unknown object type \"" + type->String + "\"");
+	}
+
+	if (!reader.Error.empty())
+	{
+		scene = Scene{};
+		error = path + ": " + reader.Error;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,135 @@
+#include "Stats.h"
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace Utils {
+	struct CounterRegistry
+	{
+		std::mutex Mutex;
+		std::vector<TraceCounters*> Threads;
+		TraceCounters Retired; // Counts of threads that have exited
+	};
+
+	static CounterRegistry& GetCounterRegistry()
+	{
+		static CounterRegistry registry;
+		return registry;
+	}
+
+	// Registers the thread's counters on first use and folds them into Retired when the thread exits
+	struct ThreadCounters
+	{
+		TraceCounters Counters;
+
+		ThreadCounters()
+		{
+			CounterRegistry& registry = GetCounterRegistry();
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			registry.Threads.push_back(&Counters);
+		}
+
+		~ThreadCounters()
+		{
+			CounterRegistry& registry = GetCounterRegistry();
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			registry.Retired += Counters;
+			registry.Threads.erase(std::find(registry.Threads.begin(), registry.Threads.end(), &Counters));
+		}
+	};
+}
+
+TraceCounters& GetThreadTraceCounters()
+{
+	thread_local Utils::ThreadCounters counters;
+	return counters.Counters;
+}
+
+TraceCounters CollectTraceCounters()
+{
+	Utils::CounterRegistry& registry = Utils::GetCounterRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	TraceCounters total = registry.Retired;
+	for (const TraceCounters* counters : registry.Threads)
+		total += *counters;
+	return total;
+}
+
+void ResetTraceCounters()
+{
+	Utils::CounterRegistry& registry = Utils::GetCounterRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+
+	registry.Retired = TraceCounters{};
+	for (TraceCounters* counters : registry.Threads)
+		*counters = TraceCounters{};
+}
+
+bool FrameStatsLog::Open(const std::string& path, std::string& error)
+{
+	Close();
+	m_File.open(path, std::ios::trunc);
+	if (!m_File)
+	{
+		error = "Failed to open " + path + " for writing";
+		return false;
+	}
+	m_Path = path;
+
+	const size_t dot = path.find_last_of('.');
+	m_CSV = dot != std::string::npos && path.compare(dot, std::string::npos, ".csv") == 0;
+	if (m_CSV)
+	{
+		m_File << "frame,frame_ms,trace_ms,mrays_per_s,rays,tiles,avg_tile_ms,max_tile_ms,"
+			"primary_rays,secondary_rays,shadow_rays,node_visits,primitive_tests";
+		for (uint32_t i = 0; i < TraceCounters::PathLengthBins; i++)
+			m_File << ",paths_" << i;
+		m_File << std::endl;
+	}
+	return true;
+}
+
+void FrameStatsLog::Close()
+{
+	if (m_File.is_open())
+		m_File.close();
+	m_Path.clear();
+}
+
+void FrameStatsLog::Write(const FrameStats& stats)
+{
+	if (!m_File.is_open())
+		return;
+
+	const TraceCounters& counters = stats.Counters;
+	char line[512];
+	if (m_CSV)
+	{
+		std::snprintf(line, sizeof(line), "%u,%.3f,%.3f,%.3f,%" PRIu64 ",%u,%.4f,%.4f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+			stats.FrameIndex, stats.FrameMs, stats.TraceMs, stats.MraysPerSecond, stats.RayCount, stats.TileCount,
+			stats.AverageTileMs, stats.MaxTileMs, counters.PrimaryRays, counters.SecondaryRays, counters.ShadowRays,
+			counters.NodeVisits, counters.PrimitiveTests);
+		m_File << line;
+		for (uint64_t count : counters.PathLengths)
+			m_File << ',' << count;
+	}
+	else
+	{
+		std::snprintf(line, sizeof(line), "{\"frame\": %u, \"frame_ms\": %.3f, \"trace_ms\": %.3f, \"mrays_per_s\": %.3f, "
+			"\"rays\": %" PRIu64 ", \"tiles\": %u, \"avg_tile_ms\": %.4f, \"max_tile_ms\": %.4f, \"primary_rays\": %" PRIu64 ", "
+			"\"secondary_rays\": %" PRIu64 ", \"shadow_rays\": %" PRIu64 ", \"node_visits\": %" PRIu64 ", \"primitive_tests\": %" PRIu64 ", "
+			"\"path_lengths\": [",
+			stats.FrameIndex, stats.FrameMs, stats.TraceMs, stats.MraysPerSecond, stats.RayCount, stats.TileCount,
+			stats.AverageTileMs, stats.MaxTileMs, counters.PrimaryRays, counters.SecondaryRays, counters.ShadowRays,
+			counters.NodeVisits, counters.PrimitiveTests);
+		m_File << line;
+		for (uint32_t i = 0; i < TraceCounters::PathLengthBins; i++)
+			m_File << (i > 0 ? ", " : "") << counters.PathLengths[i];
+		m_File << "]}";
+	}
+	m_File << std::endl;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+#include <string>
+#include <fstream>
+
+// Counters for the tracing hot paths. Every thread counts into its own block and the blocks are only summed on
+// request, so counting never contends. Define RT_STATS as 0 to compile the counting out, Dist builds do.
+#ifndef RT_STATS
+	#ifdef WL_DIST
+		#define RT_STATS 0
+	#else
+		#define RT_STATS 1
+	#endif
+#endif
+
+struct TraceCounters
+{
+	static constexpr uint32_t PathLengthBins = 16;
+
+	uint64_t NodeVisits = 0;     // BVH nodes visited, a packet visiting a node counts once
+	uint64_t PrimitiveTests = 0; // Ray-primitive intersection tests (spheres, planes and triangles)
+	uint64_t PrimaryRays = 0;    // Camera rays
+	uint64_t SecondaryRays = 0;  // Bounce rays
+	uint64_t ShadowRays = 0;     // Rays towards a sampled emitter
+	// Paths by the number of surfaces they hit before missing or being cut off, the last bin also counts longer ones
+	uint64_t PathLengths[PathLengthBins] = {};
+
+	uint64_t GetRayCount() const { return PrimaryRays + SecondaryRays + ShadowRays; }
+	uint64_t GetPathCount() const
+	{
+		uint64_t paths = 0;
+		for (uint64_t count : PathLengths)
+			paths += count;
+		return paths;
+	}
+
+	TraceCounters& operator+=(const TraceCounters& other)
+	{
+		NodeVisits += other.NodeVisits;
+		PrimitiveTests += other.PrimitiveTests;
+		PrimaryRays += other.PrimaryRays;
+		SecondaryRays += other.SecondaryRays;
+		ShadowRays += other.ShadowRays;
+		for (uint32_t i = 0; i < PathLengthBins; i++)
+			PathLengths[i] += other.PathLengths[i];
+		return *this;
+	}
+
+	TraceCounters& operator-=(const TraceCounters& other)
+	{
+		NodeVisits -= other.NodeVisits;
+		PrimitiveTests -= other.PrimitiveTests;
+		PrimaryRays -= other.PrimaryRays;
+		SecondaryRays -= other.SecondaryRays;
+		ShadowRays -= other.ShadowRays;
+		for (uint32_t i = 0; i < PathLengthBins; i++)
+			PathLengths[i] -= other.PathLengths[i];
+		return *this;
+	}
+};
+
+// Counters of the calling thread
+TraceCounters& GetThreadTraceCounters();
+// Sum over all threads, including ones that have exited. Reads the other threads' counters without
+// synchronization, so call it between frames.
+TraceCounters CollectTraceCounters();
+void ResetTraceCounters();
+
+#if RT_STATS
+	#define RT_STAT_ADD(counter, value) (GetThreadTraceCounters().counter += (value))
+	#define RT_STAT_PATH_LENGTH(length) (GetThreadTraceCounters().PathLengths[(length) < TraceCounters::PathLengthBins ? (length) : TraceCounters::PathLengthBins - 1]++)
+#else
+	#define RT_STAT_ADD(counter, value) ((void)sizeof(value))
+	#define RT_STAT_PATH_LENGTH(length) ((void)sizeof(length))
+#endif
+
+// What one Renderer::Render call did
+struct FrameStats
+{
+	uint32_t FrameIndex = 0; // Sample the frame added to the accumulation, 1 for previews
+	float FrameMs = 0.0f;    // The whole Render call
+	float TraceMs = 0.0f;    // The tile pass alone
+	float MraysPerSecond = 0.0f;
+	uint64_t RayCount = 0;   // Counted by the renderer itself, so it is also there without RT_STATS
+	uint32_t TileCount = 0;
+	float AverageTileMs = 0.0f;
+	float MaxTileMs = 0.0f;
+	TraceCounters Counters;  // Of the tile pass, all zero when RT_STATS is 0
+};
+
+// Streams one record of FrameStats per frame to a file, as CSV for a .csv path and as JSON Lines (one object per
+// line) otherwise. Every record is flushed, so a session that is killed keeps what it logged.
+class FrameStatsLog
+{
+public:
+	bool Open(const std::string& path, std::string& error);
+	void Close();
+	bool IsOpen() const { return m_File.is_open(); }
+	const std::string& GetPath() const { return m_Path; }
+
+	void Write(const FrameStats& stats);
+private:
+	std::ofstream m_File;
+	std::string m_Path;
+	bool m_CSV = false;
+};
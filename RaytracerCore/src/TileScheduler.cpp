@@ -0,0 +1,242 @@
+#include "TileScheduler.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Utils {
+	static uint64_t PackRange(uint32_t begin, uint32_t end) { return (uint64_t)begin | (uint64_t)end << 32; }
+	static uint32_t RangeBegin(uint64_t range) { return (uint32_t)range; }
+	static uint32_t RangeEnd(uint64_t range) { return (uint32_t)(range >> 32); }
+
+	// Spreads the lower 16 bits of v to the even bits
+	static uint32_t SpreadBits(uint32_t v)
+	{
+		v &= 0x0000ffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	}
+
+	static uint32_t MortonCode(uint32_t x, uint32_t y)
+	{
+		return SpreadBits(x) | (SpreadBits(y) << 1);
+	}
+}
+
+TileScheduler::TileScheduler(uint32_t threadCount)
+{
+	SetThreadCount(threadCount);
+}
+
+TileScheduler::~TileScheduler()
+{
+	StopWorkers();
+}
+
+void TileScheduler::SetThreadCount(uint32_t threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	if (threadCount == m_ThreadCount)
+		return;
+
+	StopWorkers();
+	StartWorkers(threadCount);
+}
+
+void TileScheduler::StartWorkers(uint32_t threadCount)
+{
+	m_ThreadCount = threadCount;
+	m_Queues = std::make_unique<TileQueue[]>(threadCount);
+	m_Stats.assign(threadCount, WorkerStats{});
+	m_Stopping = false;
+
+	// Thread 0 is whoever calls Run
+	for (uint32_t i = 1; i < threadCount; i++)
+		m_Workers.emplace_back(&TileScheduler::WorkerLoop, this, i, m_Generation);
+}
+
+void TileScheduler::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_WorkAvailable.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+}
+
+void TileScheduler::Run(uint32_t width, uint32_t height, uint32_t tileSize, const TileFn& fn)
+{
+	BuildTiles(width, height, std::max(tileSize, 1u));
+	if (m_Tiles.empty())
+		return;
+
+	// Deal the Morton-ordered tiles out as contiguous runs so every thread starts on its own screen region
+	const uint32_t tileCount = (uint32_t)m_Tiles.size();
+	for (uint32_t i = 0; i < m_ThreadCount; i++)
+	{
+		uint32_t begin = (uint32_t)((uint64_t)tileCount * i / m_ThreadCount);
+		uint32_t end = (uint32_t)((uint64_t)tileCount * (i + 1) / m_ThreadCount);
+		m_Queues[i].Range.store(Utils::PackRange(begin, end), std::memory_order_relaxed);
+	}
+	std::fill(m_Stats.begin(), m_Stats.end(), WorkerStats{});
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Job = &fn;
+		m_BusyWorkers = (uint32_t)m_Workers.size();
+		m_Generation++;
+	}
+	m_WorkAvailable.notify_all();
+
+	ProcessTiles(0);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkDone.wait(lock, [this] { return m_BusyWorkers == 0; });
+	m_Job = nullptr;
+}
+
+void TileScheduler::WorkerLoop(uint32_t threadIndex, uint64_t generation)
+{
+	SetProfilerThreadName("Tile Worker " + std::to_string(threadIndex));
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [&] { return m_Stopping || m_Generation != generation; });
+			if (m_Stopping)
+				return;
+			generation = m_Generation;
+		}
+
+		ProcessTiles(threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (--m_BusyWorkers == 0)
+			m_WorkDone.notify_one();
+	}
+}
+
+void TileScheduler::ProcessTiles(uint32_t threadIndex)
+{
+	WorkerStats& stats = m_Stats[threadIndex];
+	auto start = std::chrono::steady_clock::now();
+
+	uint32_t tileIndex;
+	while (true)
+	{
+		if (!PopTile(threadIndex, tileIndex))
+		{
+			if (!StealTile(threadIndex, tileIndex))
+				break;
+			stats.StolenCount++;
+		}
+
+		auto tileStart = std::chrono::steady_clock::now();
+		{
+			RT_PROFILE_SCOPE("Tile");
+			(*m_Job)(m_Tiles[tileIndex], threadIndex);
+		}
+		stats.MaxTileMs = std::max(stats.MaxTileMs, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - tileStart).count());
+		stats.TileCount++;
+	}
+
+	stats.BusyMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool TileScheduler::PopTile(uint32_t threadIndex, uint32_t& tileIndex)
+{
+	std::atomic<uint64_t>& range = m_Queues[threadIndex].Range;
+	uint64_t current = range.load(std::memory_order_relaxed);
+	while (Utils::RangeBegin(current) < Utils::RangeEnd(current))
+	{
+		uint64_t next = Utils::PackRange(Utils::RangeBegin(current) + 1, Utils::RangeEnd(current));
+		if (range.compare_exchange_weak(current, next, std::memory_order_relaxed))
+		{
+			tileIndex = Utils::RangeBegin(current);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TileScheduler::StealTile(uint32_t threadIndex, uint32_t& tileIndex)
+{
+	// Take from the back of the fullest queue, the owner keeps working on its front
+	while (true)
+	{
+		uint32_t victim = threadIndex;
+		uint32_t mostRemaining = 0;
+		for (uint32_t i = 0; i < m_ThreadCount; i++)
+		{
+			uint64_t current = m_Queues[i].Range.load(std::memory_order_relaxed);
+			uint32_t remaining = Utils::RangeEnd(current) - Utils::RangeBegin(current);
+			if (Utils::RangeBegin(current) < Utils::RangeEnd(current) && remaining > mostRemaining)
+			{
+				victim = i;
+				mostRemaining = remaining;
+			}
+		}
+		if (mostRemaining == 0)
+			return false;
+
+		std::atomic<uint64_t>& range = m_Queues[victim].Range;
+		uint64_t current = range.load(std::memory_order_relaxed);
+		if (Utils::RangeBegin(current) >= Utils::RangeEnd(current))
+			continue;
+
+		uint64_t next = Utils::PackRange(Utils::RangeBegin(current), Utils::RangeEnd(current) - 1);
+		if (range.compare_exchange_weak(current, next, std::memory_order_relaxed))
+		{
+			tileIndex = Utils::RangeEnd(current) - 1;
+			return true;
+		}
+	}
+}
+
+void TileScheduler::BuildTiles(uint32_t width, uint32_t height, uint32_t tileSize)
+{
+	if (width == m_ImageWidth && height == m_ImageHeight && tileSize == m_TileSize)
+		return;
+
+	m_ImageWidth = width;
+	m_ImageHeight = height;
+	m_TileSize = tileSize;
+
+	const uint32_t tilesX = (width + tileSize - 1) / tileSize;
+	const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+
+	struct MortonTile
+	{
+		uint32_t Code;
+		Tile Rect;
+	};
+	std::vector<MortonTile> tiles;
+	tiles.reserve(tilesX * tilesY);
+	for (uint32_t ty = 0; ty < tilesY; ty++)
+	{
+		for (uint32_t tx = 0; tx < tilesX; tx++)
+		{
+			Tile tile;
+			tile.MinX = tx * tileSize;
+			tile.MinY = ty * tileSize;
+			tile.MaxX = std::min(tile.MinX + tileSize, width);
+			tile.MaxY = std::min(tile.MinY + tileSize, height);
+			tiles.push_back({ Utils::MortonCode(tx, ty), tile });
+		}
+	}
+	std::sort(tiles.begin(), tiles.end(), [](const MortonTile& a, const MortonTile& b) { return a.Code < b.Code; });
+
+	m_Tiles.clear();
+	m_Tiles.reserve(tiles.size());
+	for (const MortonTile& tile : tiles)
+		m_Tiles.push_back(tile.Rect);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Screen rectangle [MinX, MaxX) x [MinY, MaxY)
+struct Tile
+{
+	uint32_t MinX = 0, MinY = 0;
+	uint32_t MaxX = 0, MaxY = 0;
+};
+
+struct WorkerStats
+{
+	uint32_t TileCount = 0;   // Tiles rendered by this thread in the last frame
+	uint32_t StolenCount = 0; // How many of those were taken from another thread's queue
+	float BusyMs = 0.0f;      // Time from joining the frame until no tiles were left to take
+	float MaxTileMs = 0.0f;   // Slowest single tile
+};
+
+// Persistent thread pool that renders a frame as screen tiles. Tiles are ordered along a Morton curve and dealt
+// out to the threads as contiguous runs, so each thread works on a compact screen region. A thread that runs out
+// of tiles steals from the back of another thread's run, which keeps expensive regions balanced across cores.
+class TileScheduler
+{
+public:
+	using TileFn = std::function<void(const Tile& tile, uint32_t threadIndex)>;
+
+	// threadCount 0 uses every hardware thread
+	explicit TileScheduler(uint32_t threadCount = 0);
+	~TileScheduler();
+
+	TileScheduler(const TileScheduler&) = delete;
+	TileScheduler& operator=(const TileScheduler&) = delete;
+
+	// Restarts the workers, must not be called while Run is in progress
+	void SetThreadCount(uint32_t threadCount);
+	uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+	// Calls fn for every tile of a width x height image and returns once all tiles are done. The calling thread
+	// takes part as thread 0.
+	void Run(uint32_t width, uint32_t height, uint32_t tileSize, const TileFn& fn);
+
+	const std::vector<WorkerStats>& GetStats() const { return m_Stats; }
+private:
+	void StartWorkers(uint32_t threadCount);
+	void StopWorkers();
+	void WorkerLoop(uint32_t threadIndex, uint64_t generation);
+	void ProcessTiles(uint32_t threadIndex);
+	bool PopTile(uint32_t threadIndex, uint32_t& tileIndex);
+	bool StealTile(uint32_t threadIndex, uint32_t& tileIndex);
+	void BuildTiles(uint32_t width, uint32_t height, uint32_t tileSize);
+private:
+	// Range [begin, end) of m_Tiles still to be rendered, packed as begin | end << 32 so the owner (taking from
+	// the front) and thieves (taking from the back) can claim tiles with a single compare-exchange
+	struct alignas(64) TileQueue
+	{
+		std::atomic<uint64_t> Range{ 0 };
+	};
+
+	std::vector<std::thread> m_Workers;
+	std::unique_ptr<TileQueue[]> m_Queues;
+	std::vector<WorkerStats> m_Stats;
+	std::vector<Tile> m_Tiles;
+	uint32_t m_ThreadCount = 0;
+
+	uint32_t m_ImageWidth = 0, m_ImageHeight = 0, m_TileSize = 0;
+	const TileFn* m_Job = nullptr;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkDone;
+	uint64_t m_Generation = 0;
+	uint32_t m_BusyWorkers = 0;
+	bool m_Stopping = false;
+};
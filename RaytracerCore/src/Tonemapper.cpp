@@ -0,0 +1,143 @@
+#include "Tonemapper.h"
+#include "SIMD.h"
+
+#include <cmath>
+
+namespace Utils {
+	// Narkowicz's fit of the ACES reference rendering transform
+	static constexpr float AcesA = 2.51f, AcesB = 0.03f, AcesC = 2.43f, AcesD = 0.59f, AcesE = 0.14f;
+
+	static float ToneMap(float x, ToneMapOperator op)
+	{
+		// Negative and NaN values go to black
+		x = x > 0.0f ? x : 0.0f;
+		switch (op)
+		{
+		case ToneMapOperator::Reinhard: x = x / (1.0f + x); break;
+		case ToneMapOperator::ACES:     x = (x * (AcesA * x + AcesB)) / (x * (AcesC * x + AcesD) + AcesE); break;
+		default: break;
+		}
+		return x < 1.0f ? x : 1.0f;
+	}
+
+	static float EncodeSRGB(float x)
+	{
+		return x <= 0.0031308f ? 12.92f * x : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+	}
+
+#if RT_SIMD_X64
+	static inline __m128 ToneMapSSE(__m128 x, ToneMapOperator op)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		// max returns its second operand for NaN, which sends NaN to black like the scalar version
+		x = _mm_max_ps(x, _mm_setzero_ps());
+		switch (op)
+		{
+		case ToneMapOperator::Reinhard:
+			x = _mm_div_ps(x, _mm_add_ps(one, x));
+			break;
+		case ToneMapOperator::ACES:
+		{
+			__m128 numerator = _mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(AcesA), x), _mm_set1_ps(AcesB)));
+			__m128 denominator = _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(AcesC), x), _mm_set1_ps(AcesD))), _mm_set1_ps(AcesE));
+			x = _mm_div_ps(numerator, denominator);
+			break;
+		}
+		default:
+			break;
+		}
+		return _mm_min_ps(x, one);
+	}
+
+	// Tone mapped [0, 1] values to rounded table indices
+	static inline __m128i LutIndexSSE(__m128 x, float lutMax)
+	{
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(lutMax)), _mm_set1_ps(0.5f)));
+	}
+#endif
+}
+
+const char* GetToneMapOperatorName(ToneMapOperator op)
+{
+	switch (op)
+	{
+	case ToneMapOperator::Clamp:    return "Clamp";
+	case ToneMapOperator::Reinhard: return "Reinhard";
+	case ToneMapOperator::ACES:     return "ACES";
+	}
+	return "Unknown";
+}
+
+void Tonemapper::Update()
+{
+	m_Scale = std::exp2(m_Settings.Exposure);
+	if (m_LutBuilt && m_LutSRGB == m_Settings.SRGB)
+		return;
+
+	for (uint32_t i = 0; i < LutSize; i++)
+	{
+		float value = (float)i / (float)(LutSize - 1);
+		if (m_Settings.SRGB)
+			value = Utils::EncodeSRGB(value);
+		m_Lut[i] = (uint8_t)(value * 255.0f + 0.5f);
+	}
+	m_LutSRGB = m_Settings.SRGB;
+	m_LutBuilt = true;
+}
+
+void Tonemapper::Resolve(const glm::vec3* sums, const uint32_t* sampleCounts, uint32_t* output, size_t count) const
+{
+	const ToneMapOperator op = m_Settings.Operator;
+	size_t i = 0;
+
+#if RT_SIMD_X64
+	const float lutMax = (float)(LutSize - 1);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(m_Scale);
+	alignas(16) int32_t channels[12];
+	for (; i + 4 <= count; i += 4)
+	{
+		// Four RGB pixels are twelve consecutive floats. The tone curve treats every channel alike, so they are
+		// mapped as they lie, with each pixel's scale spread over the lanes holding its channels.
+		const float* data = &sums[i].x;
+		const __m128 samples = _mm_max_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(sampleCounts + i))), one);
+		const __m128 pixelScale = _mm_div_ps(scale, samples);
+		const __m128 scale0 = _mm_shuffle_ps(pixelScale, pixelScale, _MM_SHUFFLE(1, 0, 0, 0)); // r0 g0 b0 r1
+		const __m128 scale1 = _mm_shuffle_ps(pixelScale, pixelScale, _MM_SHUFFLE(2, 2, 1, 1)); // g1 b1 r2 g2
+		const __m128 scale2 = _mm_shuffle_ps(pixelScale, pixelScale, _MM_SHUFFLE(3, 3, 3, 2)); // b2 r3 g3 b3
+
+		_mm_store_si128((__m128i*)channels, Utils::LutIndexSSE(Utils::ToneMapSSE(_mm_mul_ps(_mm_loadu_ps(data), scale0), op), lutMax));
+		_mm_store_si128((__m128i*)(channels + 4), Utils::LutIndexSSE(Utils::ToneMapSSE(_mm_mul_ps(_mm_loadu_ps(data + 4), scale1), op), lutMax));
+		_mm_store_si128((__m128i*)(channels + 8), Utils::LutIndexSSE(Utils::ToneMapSSE(_mm_mul_ps(_mm_loadu_ps(data + 8), scale2), op), lutMax));
+		for (uint32_t pixel = 0; pixel < 4; pixel++)
+		{
+			const int32_t* rgb = channels + pixel * 3;
+			output[i + pixel] = 0xff000000u | (uint32_t)m_Lut[rgb[2]] << 16 | (uint32_t)m_Lut[rgb[1]] << 8 | (uint32_t)m_Lut[rgb[0]];
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const float samples = (float)(sampleCounts[i] > 0 ? sampleCounts[i] : 1u);
+		output[i] = Resolve(sums[i] / samples);
+	}
+}
+
+void Tonemapper::Resolve(const glm::vec3* colors, uint32_t* output, size_t count) const
+{
+	for (size_t i = 0; i < count; i++)
+		output[i] = Resolve(colors[i]);
+}
+
+uint32_t Tonemapper::Resolve(const glm::vec3& color) const
+{
+	const float lutMax = (float)(LutSize - 1);
+	uint32_t rgba = 0xff000000u;
+	for (int channel = 0; channel < 3; channel++)
+	{
+		const float value = Utils::ToneMap(color[channel] * m_Scale, m_Settings.Operator);
+		rgba |= (uint32_t)m_Lut[(uint32_t)(value * lutMax + 0.5f)] << (channel * 8);
+	}
+	return rgba;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <array>
+
+enum class ToneMapOperator
+{
+	Clamp = 0, Reinhard = 1, ACES = 2
+};
+
+const char* GetToneMapOperatorName(ToneMapOperator op);
+
+// Turns linear HDR colour into display RGBA8 pixels: scales by the exposure, compresses with the tone curve and
+// encodes through a lookup table, so the sRGB transfer curve costs one load per channel. Four pixels are
+// resolved at a time with SSE on x64. The default settings reproduce the plain clamp the viewport always had.
+class Tonemapper
+{
+public:
+	struct Settings
+	{
+		float Exposure = 0.0f; // In stops, the colour is scaled by 2^Exposure
+		ToneMapOperator Operator = ToneMapOperator::Clamp;
+		bool SRGB = false; // Encode with the sRGB curve instead of writing the tone mapped value as it is
+	};
+
+	Tonemapper() { Update(); }
+
+	// Applies changed settings, call it before resolving and not while a resolve is running
+	void Update();
+
+	// count pixels of per-pixel sums, each divided by its sample count (0 is treated as 1)
+	void Resolve(const glm::vec3* sums, const uint32_t* sampleCounts, uint32_t* output, size_t count) const;
+	// count pixels of colour that is already averaged
+	void Resolve(const glm::vec3* colors, uint32_t* output, size_t count) const;
+	uint32_t Resolve(const glm::vec3& color) const;
+
+	Settings& GetSettings() { return m_Settings; }
+private:
+	static constexpr uint32_t LutSize = 4096;
+
+	Settings m_Settings;
+	float m_Scale = 1.0f;
+	bool m_LutSRGB = false;
+	bool m_LutBuilt = false;
+	std::array<uint8_t, LutSize> m_Lut{};
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+#include "Ray.h"
+#include "BVH.h"
+
+// Affine map x -> Linear * x + Translation. Linear may rotate, scale and shear, it only has to be invertible.
+struct AffineTransform
+{
+	glm::mat3 Linear{ 1.0f };
+	glm::vec3 Translation{ 0.0f };
+
+	// Scales, then rotates by Euler angles in degrees about x, then y, then z, then translates
+	static AffineTransform FromTRS(const glm::vec3& translation, const glm::vec3& rotationDegrees, const glm::vec3& scale)
+	{
+		const glm::vec3 angles = glm::radians(rotationDegrees);
+		const float cx = std::cos(angles.x), sx = std::sin(angles.x);
+		const float cy = std::cos(angles.y), sy = std::sin(angles.y);
+		const float cz = std::cos(angles.z), sz = std::sin(angles.z);
+		const glm::mat3 rotateX(1.0f, 0.0f, 0.0f, 0.0f, cx, sx, 0.0f, -sx, cx);
+		const glm::mat3 rotateY(cy, 0.0f, -sy, 0.0f, 1.0f, 0.0f, sy, 0.0f, cy);
+		const glm::mat3 rotateZ(cz, sz, 0.0f, -sz, cz, 0.0f, 0.0f, 0.0f, 1.0f);
+
+		AffineTransform transform;
+		transform.Linear = rotateZ * rotateY * rotateX;
+		for (int axis = 0; axis < 3; axis++)
+			transform.Linear[axis] *= scale[axis];
+		transform.Translation = translation;
+		return transform;
+	}
+
+	glm::vec3 TransformPoint(const glm::vec3& point) const { return Linear * point + Translation; }
+	glm::vec3 TransformDirection(const glm::vec3& direction) const { return Linear * direction; }
+	// The direction is not renormalized, so a distance along the result is the same distance along the input ray
+	Ray TransformRay(const Ray& ray) const { return Ray{ TransformPoint(ray.Origin), TransformDirection(ray.Direction) }; }
+
+	AffineTransform Inverse() const
+	{
+		AffineTransform inverse;
+		inverse.Linear = glm::inverse(Linear);
+		inverse.Translation = -(inverse.Linear * Translation);
+		return inverse;
+	}
+
+	// Smallest box around the transformed box, found per column instead of transforming all eight corners
+	AABB TransformBounds(const AABB& bounds) const
+	{
+		if (!bounds.IsValid())
+			return bounds;
+
+		AABB result{ Translation, Translation };
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const glm::vec3 a = Linear[axis] * bounds.Min[axis];
+			const glm::vec3 b = Linear[axis] * bounds.Max[axis];
+			result.Min += glm::min(a, b);
+			result.Max += glm::max(a, b);
+		}
+		return result;
+	}
+};
@@ -1,10 +1,24 @@
 -- premake5.lua
+newoption
+{
+   trigger = "headless",
+   description = "Only generate the core library and the command line tools, without Walnut and Vulkan"
+}
+
 workspace "Raytracer"
    architecture "x64"
    configurations { "Debug", "Release", "Dist" }
-   startproject "Raytracer"
+   startproject (_OPTIONS["headless"] and "RaytracerCLI" or "Raytracer")
 
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
-include "Walnut/WalnutExternal.lua"
+if not _OPTIONS["headless"] then
+   include "Walnut/WalnutExternal.lua"
+end
+
+include "RaytracerCore"
+include "RaytracerCLI"
+include "RaytracerBench"
 
-include "Raytracer"
\ No newline at end of file
+if not _OPTIONS["headless"] then
+   include "Raytracer"
+end
@@ -0,0 +1,5 @@
+#!/bin/sh
+# Generates makefiles for the core library and the command line tools only, no Vulkan SDK needed
+
+cd "$(dirname "$0")/.."
+premake5 --headless gmake2